@@ -71,7 +71,9 @@ struct channel {
 	struct lock lock;           /* Must acquire to access the controller. */
 	bool expecting_interrupt;   /* True if an interrupt is expected, false if
 								   any interrupt would be spurious. */
-	struct semaphore completion_wait;   /* Up'd by interrupt handler. */
+	struct semaphore completion_wait;   /* Up'd by disk_softirq(). */
+	int completions;            /* Completions not yet passed on. */
+	int unexpected;             /* Spurious interrupts not yet reported. */
 
 	struct disk devices[2];     /* The devices on this channel. */
 };
@@ -95,12 +97,14 @@ static void select_device (const struct disk *);
 static void select_device_wait (const struct disk *);
 
 static void interrupt_handler (struct intr_frame *);
+static softirq_func disk_softirq;
 
 /* Initialize the disk subsystem and detect disks. */
 void
 disk_init (void) {
 	size_t chan_no;
 
+	intr_register_softirq (SOFTIRQ_DISK, disk_softirq, "disk");
 	for (chan_no = 0; chan_no < CHANNEL_CNT; chan_no++) {
 		struct channel *c = &channels[chan_no];
 		int dev_no;
@@ -122,6 +126,7 @@ disk_init (void) {
 		lock_init (&c->lock);
 		c->expecting_interrupt = false;
 		sema_init (&c->completion_wait, 0);
+		c->completions = c->unexpected = 0;
 
 		/* Initialize devices. */
 		for (dev_no = 0; dev_no < 2; dev_no++) {
@@ -520,15 +525,37 @@ interrupt_handler (struct intr_frame *f) {
 		if (f->vec_no == c->irq) {
 			if (c->expecting_interrupt) {
 				inb (reg_status (c));               /* Acknowledge interrupt. */
-				sema_up (&c->completion_wait);      /* Wake up waiter. */
+				c->completions++;                   /* Wake up waiter later. */
 			} else
-				printf ("%s: unexpected interrupt\n", c->name);
+				c->unexpected++;
+			intr_raise_softirq (SOFTIRQ_DISK);
 			return;
 		}
 
 	NOT_REACHED ();
 }
 
+/* Disk softirq.  Wakes up the threads waiting for the commands
+   completed since the last run and reports spurious interrupts. */
+static void
+disk_softirq (void) {
+	struct channel *c;
+
+	for (c = channels; c < channels + CHANNEL_CNT; c++) {
+		enum intr_level old_level = intr_disable ();
+		int completions = c->completions;
+		int unexpected = c->unexpected;
+
+		c->completions = c->unexpected = 0;
+		intr_set_level (old_level);
+
+		while (completions-- > 0)
+			sema_up (&c->completion_wait);
+		while (unexpected-- > 0)
+			printf ("%s: unexpected interrupt\n", c->name);
+	}
+}
+
 static void
 inspect_read_cnt (struct intr_frame *f) {
 	struct disk * d = disk_get (f->R.rdx, f->R.rcx);
@@ -0,0 +1,202 @@
+#include "devices/hrtimer.h"
+#include <debug.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/io.h"
+#include "threads/thread.h"
+
+/* Armed timers are kept in a red-black tree ordered by expiry
+   time.  The periodic tick checks it once per tick, which is all
+   that timers due after the next tick need.  While a timer is due
+   sooner, the CMOS real-time clock's periodic interrupt is turned
+   on at 8192 Hz to check it more often.
+
+   See [MC146818A] for hardware details of the real-time clock. */
+
+/* CMOS registers.  Setting bit 7 of the index keeps NMIs masked
+   while it is selected. */
+#define CMOS_INDEX 0x70
+#define CMOS_DATA 0x71
+#define RTC_REG_A 0x8a          /* Rate select in the low 4 bits. */
+#define RTC_REG_B 0x8b          /* Bit 6 enables the periodic interrupt. */
+#define RTC_REG_C 0x0c          /* Interrupt flags; reading acknowledges. */
+#define RTC_RATE 3              /* 32768 Hz >> (RATE - 1) = 8192 Hz. */
+#define RTC_PIE 0x40
+
+static struct rb_tree hrtimers; /* Armed timers, soonest first. */
+static bool rtc_on;             /* Is the periodic interrupt enabled? */
+
+static intr_handler_func rtc_interrupt;
+static bool compare_expires_less (const struct rb_node *,
+		const struct rb_node *, void *aux);
+static void hrtimer_reprogram (int64_t now);
+static uint8_t cmos_read (uint8_t reg);
+static void cmos_write (uint8_t reg, uint8_t data);
+static void hrtimer_wakeup (void *thread);
+
+/* Sets up the real-time clock and the timer queue. */
+void
+hrtimers_init (void) {
+	rb_init (&hrtimers, compare_expires_less, NULL);
+	cmos_write (RTC_REG_A, (cmos_read (RTC_REG_A) & 0xf0) | RTC_RATE);
+	cmos_write (RTC_REG_B, cmos_read (RTC_REG_B) & ~RTC_PIE);
+	cmos_read (RTC_REG_C);
+	intr_register_ext (0x28, rtc_interrupt, "MC146818A RTC");
+	intr_register_softirq (SOFTIRQ_HRTIMER, hrtimer_run, "hrtimer");
+}
+
+/* Initializes TIMER to call FUNC with AUX when it expires. */
+void
+hrtimer_init (struct hrtimer *timer, hrtimer_func *func, void *aux) {
+	ASSERT (timer != NULL);
+	ASSERT (func != NULL);
+
+	timer->func = func;
+	timer->aux = aux;
+	timer->armed = false;
+}
+
+/* Arms TIMER to expire at timer_ns() time EXPIRES, rearming it
+   if it is already armed.  If EXPIRES has passed, TIMER expires
+   at the next check.  May be called from an interrupt handler. */
+void
+hrtimer_start (struct hrtimer *timer, int64_t expires) {
+	enum intr_level old_level = intr_disable ();
+
+	if (timer->armed)
+		rb_remove (&hrtimers, &timer->node);
+	timer->expires = expires;
+	timer->armed = true;
+	rb_insert (&hrtimers, &timer->node);
+	hrtimer_reprogram (timer_ns ());
+	intr_set_level (old_level);
+}
+
+/* Disarms TIMER.  Returns true if it was armed, false if it had
+   already expired or was never armed. */
+bool
+hrtimer_cancel (struct hrtimer *timer) {
+	enum intr_level old_level = intr_disable ();
+	bool armed = timer->armed;
+
+	if (armed) {
+		rb_remove (&hrtimers, &timer->node);
+		timer->armed = false;
+	}
+	intr_set_level (old_level);
+	return armed;
+}
+
+/* Returns the expiry time of the soonest armed timer, or INT64_MAX
+   if none is armed.  Interrupts must be off. */
+int64_t
+hrtimer_next_expiry (void) {
+	struct rb_node *first = rb_first (&hrtimers);
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	return first != NULL
+		? rb_entry (first, struct hrtimer, node)->expires : INT64_MAX;
+}
+
+/* Expires every armed timer that is due, calling its function
+   with interrupts off, then turns the real-time clock on or off
+   for the next one.  Runs in the hrtimer and timer softirqs. */
+void
+hrtimer_run (void) {
+	enum intr_level old_level = intr_disable ();
+	int64_t now = timer_ns ();
+	struct rb_node *first;
+
+	while ((first = rb_first (&hrtimers)) != NULL) {
+		struct hrtimer *timer = rb_entry (first, struct hrtimer, node);
+
+		if (timer->expires > now)
+			break;
+		rb_remove (&hrtimers, first);
+		timer->armed = false;
+		timer->func (timer->aux);
+	}
+	hrtimer_reprogram (now);
+	intr_set_level (old_level);
+}
+
+/* Blocks the current thread until timer_ns() time NS. */
+void
+hrtimer_sleep_until (int64_t ns) {
+	struct hrtimer timer;
+	enum intr_level old_level;
+
+	ASSERT (!intr_context ());
+
+	hrtimer_init (&timer, hrtimer_wakeup, thread_current ());
+	old_level = intr_disable ();
+	if (timer_ns () < ns) {
+		hrtimer_start (&timer, ns);
+		thread_block ();
+	}
+	intr_set_level (old_level);
+}
+
+/* Wakes up THREAD, which is sleeping in hrtimer_sleep_until(). */
+static void
+hrtimer_wakeup (void *thread) {
+	thread_unblock (thread);
+
+	/* Outside interrupt context, this is the idle thread catching
+	   up in timer_nohz_exit(), and it is about to block anyway. */
+	if (intr_context ())
+		thread_try_preempt ();
+}
+
+/* Real-time clock interrupt handler. */
+static void
+rtc_interrupt (struct intr_frame *args UNUSED) {
+	cmos_read (RTC_REG_C);
+	intr_raise_softirq (SOFTIRQ_HRTIMER);
+}
+
+/* Turns the real-time clock's periodic interrupt on if the soonest
+   timer is due before the next tick, or off otherwise.  NOW is the
+   current timer_ns() time.  Interrupts must be off.
+
+   One extra RTC period of slack keeps a timer that is due just
+   after the next tick from being missed by it when timer_ns()
+   runs slightly fast against the 8254. */
+static void
+hrtimer_reprogram (int64_t now) {
+	bool on = (hrtimer_next_expiry () - now
+	           < NSEC_PER_SEC / TIMER_FREQ + HRTIMER_RESOLUTION_NS);
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (on != rtc_on) {
+		uint8_t b = cmos_read (RTC_REG_B);
+		cmos_write (RTC_REG_B, on ? b | RTC_PIE : b & ~RTC_PIE);
+		rtc_on = on;
+	}
+}
+
+/* Orders timers by expiry time. */
+static bool
+compare_expires_less (const struct rb_node *a_, const struct rb_node *b_,
+		void *aux UNUSED) {
+	const struct hrtimer *a = rb_entry (a_, struct hrtimer, node);
+	const struct hrtimer *b = rb_entry (b_, struct hrtimer, node);
+
+	return a->expires < b->expires;
+}
+
+/* Returns the value of CMOS register REG. */
+static uint8_t
+cmos_read (uint8_t reg) {
+	outb (CMOS_INDEX, reg);
+	return inb (CMOS_DATA);
+}
+
+/* Sets CMOS register REG to DATA. */
+static void
+cmos_write (uint8_t reg, uint8_t data) {
+	outb (CMOS_INDEX, reg);
+	outb (CMOS_DATA, data);
+}
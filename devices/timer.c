@@ -3,10 +3,12 @@
 #include <inttypes.h>
 #include <round.h>
 #include <stdio.h>
+#include "devices/hrtimer.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "intrinsic.h"
 
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -17,16 +19,68 @@
 #error TIMER_FREQ <= 1000 recommended
 #endif
 
+/* 8254 input frequency and the counter value for one timer tick,
+   rounded to nearest. */
+#define PIT_HZ 1193180
+#define PIT_TICK_COUNT ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Longest one-shot interval the 16-bit counter can hold, in
+   ticks. */
+#define NOHZ_MAX_TICKS (0xffff / PIT_TICK_COUNT)
+
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
-/* Number of loops per timer tick.
-   Initialized by timer_calibrate(). */
-static unsigned loops_per_tick;
+/* Lets timer_ticks() read TICKS without disabling interrupts. */
+static struct seqlock ticks_seqlock;
+
+/* Ticks whose bookkeeping timer_softirq() has done.  Lags TICKS
+   only while the timer softirq is pending. */
+static int64_t ticks_done;
+
+/* If false (default), the timer interrupts TIMER_FREQ times per
+   second at all times.
+   If true, the periodic tick is stopped while the CPU is idle.
+   Controlled by kernel command-line option "-nohz". */
+bool timer_nohz;
+
+/* One-shot state while the periodic tick is stopped. */
+static bool nohz_active;        /* Is a one-shot interval armed? */
+static int64_t nohz_ticks;      /* Ticks covered by the interval. */
+static uint16_t nohz_count;     /* Counter value it was armed with. */
+static uint16_t nohz_first;     /* Counts until the first tick boundary. */
+
+/* Number of timer ticks to measure the TSC over. */
+#define CALIBRATE_TICKS (TIMER_FREQ / 10)
+
+/* Converts TSC cycles to nanoseconds as (CYCLES * TSC_MULT) >>
+   TSC_SHIFT.  Both mult and base are set by timer_calibrate();
+   until then TSC_MULT is 0 and timer_ns() counts whole ticks. */
+#define TSC_SHIFT 32
+static uint64_t tsc_mult;
+static uint64_t tsc_base;       /* TSC when timer_ns() read BASE_NS. */
+static int64_t base_ns;
+
+/* TSC cycles per tick spent with interrupts off in the timer:
+   all of timer_interrupt(), plus the tick's timer_tick_update()
+   call in the timer softirq. */
+static uint64_t intr_cycles_max;
+static uint64_t intr_cycles_total;
+static int64_t intr_cnt;
+
+/* Cycles spent in timer_interrupt() for ticks that the timer
+   softirq has not yet done the bookkeeping for. */
+static uint64_t intr_cycles_pending;
 
 static intr_handler_func timer_interrupt;
-static bool too_many_loops (unsigned loops);
-static void busy_wait (int64_t loops);
+static softirq_func timer_softirq;
+static void timer_tick_update (int64_t tick);
+static void timer_catch_up (int64_t cnt);
+static void timer_account (uint64_t cycles);
+static void pit_program (uint8_t control, uint16_t count);
+static uint16_t pit_read_count (bool *expired);
+static bool pit_tick_pending (void);
+static int64_t pit_time (uint64_t *tsc);
 static void real_time_sleep (int64_t num, int32_t denom);
 
 /* Sets up the 8254 Programmable Interval Timer (PIT) to
@@ -34,49 +88,57 @@ static void real_time_sleep (int64_t num, int32_t denom);
    corresponding interrupt. */
 void
 timer_init (void) {
-	/* 8254 input frequency divided by TIMER_FREQ, rounded to
-	   nearest. */
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
-
-	outb (0x43, 0x34);    /* CW: counter 0, LSB then MSB, mode 2, binary. */
-	outb (0x40, count & 0xff);
-	outb (0x40, count >> 8);
+	seqlock_init (&ticks_seqlock);
+	pit_program (0x34, PIT_TICK_COUNT); /* CW: counter 0, LSB then MSB, mode 2, binary. */
 
 	intr_register_ext (0x20, timer_interrupt, "8254 Timer");
+	intr_register_softirq (SOFTIRQ_TIMER, timer_softirq, "timer");
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* Measures the TSC frequency against the timer, which timer_ns()
+   then uses to tell time between ticks. */
 void
 timer_calibrate (void) {
-	unsigned high_bit, test_bit;
+	int64_t start, pit_start, pit_end;
+	uint64_t tsc_start, tsc_end, tsc_hz;
+	enum intr_level old_level;
 
 	ASSERT (intr_get_level () == INTR_ON);
 	printf ("Calibrating timer...  ");
 
-	/* Approximate loops_per_tick as the largest power-of-two
-	   still less than one timer tick. */
-	loops_per_tick = 1u << 10;
-	while (!too_many_loops (loops_per_tick << 1)) {
-		loops_per_tick <<= 1;
-		ASSERT (loops_per_tick != 0);
-	}
-
-	/* Refine the next 8 bits of loops_per_tick. */
-	high_bit = loops_per_tick;
-	for (test_bit = high_bit >> 1; test_bit != high_bit >> 10; test_bit >>= 1)
-		if (!too_many_loops (high_bit | test_bit))
-			loops_per_tick |= test_bit;
+	/* Count cycles over CALIBRATE_TICKS ticks, timed by the 8254
+	   counter itself rather than by when its interrupts arrive,
+	   which QEMU can deliver late. */
+	old_level = intr_disable ();
+	pit_start = pit_time (&tsc_start);
+	start = ticks;
+	intr_set_level (old_level);
+	while (ticks - start < CALIBRATE_TICKS)
+		barrier ();
+	old_level = intr_disable ();
+	pit_end = pit_time (&tsc_end);
+	tsc_hz = (tsc_end - tsc_start) * PIT_HZ / (pit_end - pit_start);
+
+	/* Carry on from the tick count, so that timer_ns() never
+	   goes backward. */
+	base_ns = timer_ns ();
+	tsc_base = tsc_end;
+	tsc_mult = (NSEC_PER_SEC << TSC_SHIFT) / tsc_hz;
+	intr_set_level (old_level);
 
-	printf ("%'"PRIu64" loops/s.\n", (uint64_t) loops_per_tick * TIMER_FREQ);
+	printf ("%'"PRIu64" cycles/s.\n", tsc_hz);
 }
 
 /* Returns the number of timer ticks since the OS booted. */
 int64_t
 timer_ticks (void) {
-	enum intr_level old_level = intr_disable ();
-	int64_t t = ticks;
-	intr_set_level (old_level);
-	barrier ();
+	unsigned seq;
+	int64_t t;
+
+	do {
+		seq = seqlock_read_begin (&ticks_seqlock);
+		t = ticks;
+	} while (seqlock_read_retry (&ticks_seqlock, seq));
 	return t;
 }
 
@@ -87,6 +149,17 @@ timer_elapsed (int64_t then) {
 	return timer_ticks () - then;
 }
 
+/* Returns the number of nanoseconds since the OS booted.  The
+   clock never goes backward.  Before timer_calibrate() it only
+   advances once per tick. */
+int64_t
+timer_ns (void) {
+	if (tsc_mult == 0)
+		return timer_ticks () * (NSEC_PER_SEC / TIMER_FREQ);
+	return base_ns + (int64_t) (((unsigned __int128) (rdtsc () - tsc_base)
+				* tsc_mult) >> TSC_SHIFT);
+}
+
 /* Suspends execution for approximately TICKS timer ticks. */
 /* Lab #1 - 수정해야 할 부분. while 부를 제거하고 저기에 thread_sleep을 집어 넣어야 한다.*/ 
 void
@@ -127,86 +200,267 @@ timer_print_stats (void) {
 	printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
 }
 
+/* Stores the longest and the mean number of TSC cycles per tick
+   that the timer spent with interrupts off, in the interrupt
+   handler and in the timer softirq, since the last reset into
+   *MAX and *AVG. */
+void
+timer_intr_stats (uint64_t *max, uint64_t *avg) {
+	enum intr_level old_level = intr_disable ();
+	*max = intr_cycles_max;
+	*avg = intr_cnt > 0 ? intr_cycles_total / intr_cnt : 0;
+	intr_set_level (old_level);
+}
+
+/* Resets the statistics reported by timer_intr_stats(). */
+void
+timer_intr_stats_reset (void) {
+	enum intr_level old_level = intr_disable ();
+	intr_cycles_max = 0;
+	intr_cycles_total = 0;
+	intr_cnt = 0;
+	intr_set_level (old_level);
+}
+
+/* Stops the periodic tick before the idle thread halts, if
+   "-nohz" is in effect: arms a one-shot interval that ends at the
+   next tick on which thread_wake() has work to do.  Must be
+   called with interrupts off. */
+void
+timer_nohz_enter (void) {
+	int64_t skip, hrtimer_skip;
+	uint16_t left;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (!timer_nohz || nohz_active)
+		return;
+
+	skip = thread_next_wakeup (ticks + NOHZ_MAX_TICKS) - ticks;
+	/* Wake up for the tick before the next high-resolution timer
+	   is due, which hands it over to the real-time clock. */
+	hrtimer_skip = (hrtimer_next_expiry () - timer_ns ()) / (NSEC_PER_SEC / TIMER_FREQ);
+	if (hrtimer_skip < skip)
+		skip = hrtimer_skip;
+	if (skip <= 1)
+		return;
+
+	/* A tick that is already pending at the PIC would be mistaken
+	   for the end of the one-shot interval. */
+	if (pit_tick_pending ())
+		return;
+
+	/* Keep the phase of the periodic tick: the first tick of the
+	   interval ends where the current period would have. */
+	left = pit_read_count (NULL);
+	nohz_first = left;
+	nohz_count = left + (skip - 1) * PIT_TICK_COUNT;
+	nohz_ticks = skip;
+	nohz_active = true;
+	pit_program (0x30, nohz_count); /* CW: counter 0, LSB then MSB, mode 0, binary. */
+}
+
+/* Restarts the periodic tick after the idle thread wakes up, if
+   some interrupt other than the timer ended the halt early, and
+   accounts for the whole ticks that passed in the meantime. */
+void
+timer_nohz_exit (void) {
+	enum intr_level old_level = intr_disable ();
+
+	if (nohz_active) {
+		bool expired;
+		uint16_t left = pit_read_count (&expired);
+
+		/* If the interval already ran out, its interrupt is pending
+		   and timer_interrupt() will catch up instead. */
+		if (!expired) {
+			int64_t elapsed = nohz_count - left;
+			int64_t cnt = 0;
+
+			if (elapsed >= nohz_first)
+				cnt = 1 + (elapsed - nohz_first) / PIT_TICK_COUNT;
+
+			/* The periodic tick restarts from here, so up to one
+			   tick of phase is lost. */
+			nohz_active = false;
+			pit_program (0x34, PIT_TICK_COUNT);
+			timer_catch_up (cnt);
+			timer_softirq ();
+		}
+	}
+	intr_set_level (old_level);
+}
+
 /* Timer interrupt handler. */
-/* Lab #1 - timer_interrupt가 매번 global_tick 확인해서 쓰레드 깨우도록*/
+/* Lab #1 - timer_interrupt가 매 tick마다 sleep wheel을 확인해서 쓰레드 깨우도록*/
 static void
-timer_interrupt (struct intr_frame *args UNUSED) {
+timer_interrupt (struct intr_frame *args) {
+	uint64_t start = rdtsc ();
+
+	/* End of a one-shot interval: go back to the periodic tick and
+	   replay the ticks that were skipped while idle. */
+	if (nohz_active) {
+		nohz_active = false;
+		pit_program (0x34, PIT_TICK_COUNT);
+		timer_catch_up (nohz_ticks - 1);
+	}
+
+	seqlock_write_begin (&ticks_seqlock);
 	ticks++;
-	thread_tick ();
+	seqlock_write_end (&ticks_seqlock);
+	thread_tick ((args->cs & 3) == 3);
+	intr_raise_softirq (SOFTIRQ_TIMER);
+
+	intr_cycles_pending += rdtsc () - start;
+}
+
+/* Timer softirq.  Does the bookkeeping for every tick since the
+   last run, with interrupts off for one tick at a time only. */
+static void
+timer_softirq (void) {
+	enum intr_level old_level = intr_disable ();
+
+	while (ticks_done < ticks) {
+		uint64_t start = rdtsc ();
 
+		timer_tick_update (++ticks_done);
+		timer_account (rdtsc () - start);
+		intr_set_level (old_level);
+		old_level = intr_disable ();
+	}
+	intr_set_level (old_level);
+	hrtimer_run ();
+}
+
+/* Scheduler bookkeeping done once for each TICK, after TICKS has
+   been advanced past it.  Interrupts must be off. */
+static void
+timer_tick_update (int64_t tick) {
 	/* Lab #1 - advanced 구현에 사용*/
 	if(thread_mlfqs){
 		//현재 실행중인 쓰레드의 recent_cpu 값을 1 증가.
 		advanced_recent_cpu_increase();
-		//tick이 4 지날때마다 priority 계산을 돌려준다.
-		if(ticks % 4 == 0){
+		//지난 decay epoch를 놓친 쓰레드 몇 개를 따라잡게 한다.
+		advanced_decay_step();
+		//tick이 4 지날때마다 현재 쓰레드의 priority 계산을 돌려준다.
+		if(tick % 4 == 0){
 			advanced_priority_update();
 		}
 
-		if(ticks % TIMER_FREQ == 0){
+		if(tick % TIMER_FREQ == 0){
 			//load_avg의 값이 recent_cpu 값에 적용되므로 load_avg를 먼저 update해 준다.
 			advanced_load_avg_calculation();
-			//load_avg가 업데이트 되었으므로 이를 이용하여 recent_cpu를 업데이트 해 준다.
+			//load_avg가 업데이트 되었으므로 이를 이용하여 새 decay epoch를 시작한다.
 			advanced_recent_cpu_update();
 		}
 	}
 	
-	thread_wake(ticks);
+	thread_wake(tick);
 }
 
-/* Returns true if LOOPS iterations waits for more than one timer
-   tick, otherwise false. */
-static bool
-too_many_loops (unsigned loops) {
-	/* Wait for a timer tick. */
-	int64_t start = ticks;
-	while (ticks == start)
-		barrier ();
+/* Advances the clock by CNT ticks during which the idle thread
+   was halted with the periodic tick stopped.  The timer softirq
+   does the per-tick bookkeeping that was missed. */
+static void
+timer_catch_up (int64_t cnt) {
+	ASSERT (intr_get_level () == INTR_OFF);
 
-	/* Run LOOPS loops. */
-	start = ticks;
-	busy_wait (loops);
+	thread_tick_idle (cnt);
+	seqlock_write_begin (&ticks_seqlock);
+	ticks += cnt;
+	seqlock_write_end (&ticks_seqlock);
+}
 
-	/* If the tick count changed, we iterated too long. */
-	barrier ();
-	return start != ticks;
+/* Records CYCLES spent on one tick's bookkeeping, together with
+   the interrupt handler time not yet charged to any tick, in the
+   statistics reported by timer_intr_stats().  Ticks replayed after
+   nohz idle had no interrupt of their own.  Interrupts must be
+   off. */
+static void
+timer_account (uint64_t cycles) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	cycles += intr_cycles_pending;
+	intr_cycles_pending = 0;
+	if (cycles > intr_cycles_max)
+		intr_cycles_max = cycles;
+	intr_cycles_total += cycles;
+	intr_cnt++;
 }
 
-/* Iterates through a simple loop LOOPS times, for implementing
-   brief delays.
+/* Writes CONTROL to the 8254 control register and loads COUNT
+   into counter 0. */
+static void
+pit_program (uint8_t control, uint16_t count) {
+	outb (0x43, control);
+	outb (0x40, count & 0xff);
+	outb (0x40, count >> 8);
+}
 
-   Marked NO_INLINE because code alignment can significantly
-   affect timings, so that if this function was inlined
-   differently in different places the results would be difficult
-   to predict. */
-static void NO_INLINE
-busy_wait (int64_t loops) {
-	while (loops-- > 0)
-		barrier ();
+/* Returns the current value of counter 0.  If EXPIRED is
+   non-null, also stores whether its output is high, which in
+   mode 0 means the count has run out. */
+static uint16_t
+pit_read_count (bool *expired) {
+	uint8_t status, lo, hi;
+
+	outb (0x43, 0xc2);    /* Read-back: latch count and status of counter 0. */
+	status = inb (0x40);
+	lo = inb (0x40);
+	hi = inb (0x40);
+	if (expired != NULL)
+		*expired = (status & 0x80) != 0;
+	return lo | (hi << 8);
+}
+
+/* Returns true if a timer interrupt is pending at the PIC. */
+static bool
+pit_tick_pending (void) {
+	outb (0x20, 0x0a);    /* OCW3: read IRR. */
+	return (inb (0x20) & 0x01) != 0;
+}
+
+/* Returns the number of 8254 input clocks since the OS booted,
+   counting a tick whose interrupt is still pending, and stores
+   the TSC read at the same moment into *TSC.  Only valid while
+   the periodic tick runs.  Interrupts must be off. */
+static int64_t
+pit_time (uint64_t *tsc) {
+	bool pending;
+	uint16_t count;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	/* Retry if the counter reloaded while we looked. */
+	do {
+		pending = pit_tick_pending ();
+		*tsc = rdtsc ();
+		count = pit_read_count (NULL);
+	} while (pit_tick_pending () != pending);
+
+	return (ticks + pending) * PIT_TICK_COUNT + (PIT_TICK_COUNT - count);
 }
 
 /* Sleep for approximately NUM/DENOM seconds. */
 static void
 real_time_sleep (int64_t num, int32_t denom) {
-	/* Convert NUM/DENOM seconds into timer ticks, rounding down.
-
-	   (NUM / DENOM) s
-	   ---------------------- = NUM * TIMER_FREQ / DENOM ticks.
-	   1 s / TIMER_FREQ ticks
-	   */
+	/* Convert NUM/DENOM seconds into a deadline in nanoseconds.
+	   DENOM divides NSEC_PER_SEC, so this cannot lose precision. */
+	int64_t deadline = timer_ns () + num * (NSEC_PER_SEC / denom);
 	int64_t ticks = num * TIMER_FREQ / denom;
 
 	ASSERT (intr_get_level () == INTR_ON);
-	if (ticks > 0) {
-		/* We're waiting for at least one full timer tick.  Use
-		   timer_sleep() because it will yield the CPU to other
-		   processes. */
-		timer_sleep (ticks);
-	} else {
-		/* Otherwise, use a busy-wait loop for more accurate
-		   sub-tick timing.  We scale the numerator and denominator
-		   down by 1000 to avoid the possibility of overflow. */
-		ASSERT (denom % 1000 == 0);
-		busy_wait (loops_per_tick * num / 1000 * TIMER_FREQ / (denom / 1000));
-	}
+	ASSERT (NSEC_PER_SEC % denom == 0);
+
+	/* Sleep through all but the last whole tick with timer_sleep(),
+	   which may wake us up to a tick early, then sleep out the rest
+	   on a high-resolution timer. */
+	if (ticks > 1)
+		timer_sleep (ticks - 1);
+	if (deadline - timer_ns () >= HRTIMER_RESOLUTION_NS)
+		hrtimer_sleep_until (deadline);
+
+	/* Too close to the deadline to be worth blocking. */
+	while (timer_ns () < deadline)
+		barrier ();
 }
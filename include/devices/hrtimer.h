@@ -0,0 +1,33 @@
+#ifndef DEVICES_HRTIMER_H
+#define DEVICES_HRTIMER_H
+
+#include <rbtree.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* High-resolution timers, which expire at a given timer_ns()
+   time rather than on a timer tick.  They are late by up to
+   HRTIMER_RESOLUTION_NS. */
+#define HRTIMER_RESOLUTION_NS (1000000000LL / 8192)
+
+typedef void hrtimer_func (void *aux);
+
+/* A high-resolution timer.  The caller owns it; it is linked into
+   the timer queue only while armed. */
+struct hrtimer {
+	struct rb_node node;        /* Node in the timer queue. */
+	int64_t expires;            /* timer_ns() time to expire at. */
+	hrtimer_func *func;         /* Called on expiry. */
+	void *aux;                  /* Argument for FUNC. */
+	bool armed;                 /* In the timer queue? */
+};
+
+void hrtimers_init (void);
+void hrtimer_init (struct hrtimer *, hrtimer_func *, void *aux);
+void hrtimer_start (struct hrtimer *, int64_t expires);
+bool hrtimer_cancel (struct hrtimer *);
+int64_t hrtimer_next_expiry (void);
+void hrtimer_run (void);
+void hrtimer_sleep_until (int64_t ns);
+
+#endif /* devices/hrtimer.h */
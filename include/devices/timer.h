@@ -2,22 +2,35 @@
 #define DEVICES_TIMER_H
 
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* Nanoseconds per second. */
+#define NSEC_PER_SEC 1000000000LL
+
+/* Stop the periodic tick while idle.  Set by "-nohz". */
+extern bool timer_nohz;
+
 void timer_init (void);
 void timer_calibrate (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
+int64_t timer_ns (void);
 
 void timer_sleep (int64_t ticks);
 void timer_msleep (int64_t milliseconds);
 void timer_usleep (int64_t microseconds);
 void timer_nsleep (int64_t nanoseconds);
 
+void timer_nohz_enter (void);
+void timer_nohz_exit (void);
+
 void timer_print_stats (void);
+void timer_intr_stats (uint64_t *max, uint64_t *avg);
+void timer_intr_stats_reset (void);
 
 #endif /* devices/timer.h */
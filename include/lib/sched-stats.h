@@ -0,0 +1,15 @@
+#ifndef __LIB_SCHED_STATS_H
+#define __LIB_SCHED_STATS_H
+
+/* Scheduling statistics of one thread, kept by the kernel and
+   returned to user programs by get_sched_stats(). */
+struct sched_stats {
+	long long run_delay;            /* Nanoseconds spent ready but not running. */
+	long long wakeups;              /* Times woken from the blocked state. */
+	long long voluntary_switches;   /* Times it gave up the CPU by blocking. */
+	long long involuntary_switches; /* Times it was preempted or yielded. */
+	long long user_ticks;           /* Timer ticks spent in user mode. */
+	long long kernel_ticks;         /* Timer ticks spent in kernel mode. */
+};
+
+#endif /* lib/sched-stats.h */
@@ -36,6 +36,18 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Scheduling extensions. */
+	SYS_SCHED_DEADLINE,         /* Join or leave the deadline class. */
+	SYS_CPU_MAX,                /* Limit the CPU time of a process tree. */
+	SYS_CPU_THROTTLED,          /* Report ticks spent throttled. */
+	SYS_SCHED_STATS,            /* Report scheduling statistics. */
+
+	/* Synchronization extensions. */
+	SYS_FUTEX,                  /* Wait on or wake a shared int. */
+
+	/* Time extensions. */
+	SYS_CLOCK_NS,               /* Read the monotonic clock. */
 };
 
 #endif /* lib/syscall-nr.h */
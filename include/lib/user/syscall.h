@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <sched-stats.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -13,6 +14,10 @@ typedef int pid_t;
 typedef int off_t;
 #define MAP_FAILED ((void *) NULL)
 
+/* Operations for futex(). */
+#define FUTEX_WAIT 0            /* Sleep if *uaddr == val. */
+#define FUTEX_WAKE 1            /* Wake up to val sleepers. */
+
 /* Maximum characters in a filename written by readdir(). */
 #define READDIR_MAX_LEN 14
 
@@ -52,6 +57,18 @@ bool isdir (int fd);
 int inumber (int fd);
 int symlink (const char* target, const char* linkpath);
 
+/* Scheduling extensions. */
+bool sched_deadline (int runtime, int deadline, int period);
+bool cpu_max (int quota, int period);
+long long cpu_throttled (void);
+void get_sched_stats (struct sched_stats *);
+
+/* Synchronization extensions. */
+int futex (int *uaddr, int op, int val);
+
+/* Time extensions. */
+long long clock_ns (void);
+
 static inline void* get_phys_addr (void *user_addr) {
 	void* pa;
 	asm volatile ("movq %0, %%rax" ::"r"(user_addr));
@@ -65,10 +65,23 @@ struct intr_frame {
 
 typedef void intr_handler_func (struct intr_frame *);
 
+/* Softirqs, the deferred halves of external interrupt handlers.
+   Lower numbers run first. */
+enum softirq {
+	SOFTIRQ_HRTIMER,            /* High-resolution timers. */
+	SOFTIRQ_TIMER,              /* Timer bookkeeping and sleepers. */
+	SOFTIRQ_DISK,               /* Disk completions. */
+	SOFTIRQ_CNT
+};
+
+typedef void softirq_func (void);
+
 void intr_init (void);
 void intr_register_ext (uint8_t vec, intr_handler_func *, const char *name);
 void intr_register_int (uint8_t vec, int dpl, enum intr_level,
                         intr_handler_func *, const char *name);
+void intr_register_softirq (enum softirq, softirq_func *, const char *name);
+void intr_raise_softirq (enum softirq);
 bool intr_context (void);
 void intr_yield_on_return (void);
 
@@ -0,0 +1,13 @@
+#ifndef THREADS_IRQSOFF_H
+#define THREADS_IRQSOFF_H
+
+/* Interrupts-off latency tracer.  Built into the kernel only with
+   "make IRQSOFF=1", which defines IRQSOFF; see threads/irqsoff.c. */
+
+#include <stdbool.h>
+
+void irqsoff_begin (bool user);
+void irqsoff_end (bool user);
+void irqsoff_print_stats (void);
+
+#endif /* threads/irqsoff.h */
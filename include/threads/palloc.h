@@ -1,6 +1,7 @@
 #ifndef THREADS_PALLOC_H
 #define THREADS_PALLOC_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -14,10 +15,27 @@ enum palloc_flags {
 /* Maximum number of pages to put in user pool. */
 extern size_t user_page_limit;
 
+/* Free user pages kept by a thread, so that single-page user
+   allocations and frees reach the pools only in batches.  Owned
+   by palloc.c. */
+#define PALLOC_MAGAZINE_SIZE 8
+struct palloc_magazine {
+	size_t cnt;                             /* # of pages held. */
+	void *pages[PALLOC_MAGAZINE_SIZE];      /* Free pages, most recent last. */
+};
+
 uint64_t palloc_init (void);
+void palloc_zero_init (void);
 void *palloc_get_page (enum palloc_flags);
 void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
+bool palloc_extend_multiple (void *, size_t page_cnt, size_t new_cnt);
+void palloc_set_owner (void *, size_t page_cnt, void *owner);
+void *palloc_get_owner (const void *);
+size_t palloc_get_batch (enum palloc_flags, void **pages, size_t page_cnt);
+void palloc_free_batch (void **pages, size_t page_cnt);
+void palloc_flush_magazine (void);
+void palloc_print_stats (void);
 
 #endif /* threads/palloc.h */
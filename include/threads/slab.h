@@ -0,0 +1,24 @@
+#ifndef THREADS_SLAB_H
+#define THREADS_SLAB_H
+
+#include <stddef.h>
+
+/* Object caches.  A cache hands out objects of one exact size,
+   carved from pages of its own, so that a frequently allocated
+   structure neither wastes the slack of a power-of-2 malloc()
+   block nor contends for a malloc() descriptor lock with
+   unrelated allocations.  See slab.c for details. */
+
+/* Optional constructor, run on each object once, when the page
+   holding it is added to the cache.  Objects must be returned to
+   kmem_cache_free() in their constructed state. */
+typedef void kmem_ctor (void *obj);
+
+void kmem_init (void);
+struct kmem_cache *kmem_cache_create (const char *name, size_t size,
+		kmem_ctor *ctor);
+void *kmem_cache_alloc (struct kmem_cache *);
+void kmem_cache_free (struct kmem_cache *, void *obj);
+void kmem_print_stats (void);
+
+#endif /* threads/slab.h */
@@ -0,0 +1,14 @@
+#ifndef THREADS_SWITCH_H
+#define THREADS_SWITCH_H
+
+#include <stdint.h>
+#include "threads/interrupt.h"
+
+/* Saves the callee-saved registers of the running thread and
+   stores its stack pointer into *CUR_RSP, then resumes the thread
+   whose stack pointer is NEXT_RSP, or launches NEXT_TF with iretq
+   if NEXT_RSP is zero. */
+void switch_threads (uint64_t *cur_rsp, uint64_t next_rsp,
+                     struct intr_frame *next_tf);
+
+#endif /* threads/switch.h */
@@ -2,12 +2,30 @@
 #define THREADS_SYNCH_H
 
 #include <list.h>
+#include <rbtree.h>
 #include <stdbool.h>
 
+struct thread;
+
+/* Threads blocked on a synchronization object, highest priority
+   first and in FIFO order among equals.  Adding a waiter, waking
+   the first one, and moving one after its priority changes all
+   take O(log n) time.  Interrupts must be off while using it. */
+struct wait_queue {
+	struct rb_tree threads;     /* Waiting threads, by priority. */
+};
+
+void wait_queue_init (struct wait_queue *);
+bool wait_queue_empty (const struct wait_queue *);
+void wait_queue_push (struct wait_queue *, struct thread *);
+struct thread *wait_queue_pop (struct wait_queue *);
+void wait_queue_remove (struct thread *);
+void wait_queue_set_priority (struct thread *, int priority);
+
 /* A counting semaphore. */
 struct semaphore {
 	unsigned value;             /* Current value. */
-	struct list waiters;        /* List of waiting threads. */
+	struct wait_queue waiters;  /* Waiting threads. */
 };
 
 void sema_init (struct semaphore *, unsigned value);
@@ -20,17 +38,62 @@ void sema_self_test (void);
 struct lock {
 	struct thread *holder;      /* Thread holding lock (for debugging). */
 	struct semaphore semaphore; /* Binary semaphore controlling access. */
+	int priority;               /* Highest priority donated, or -1. */
+	struct rb_node holder_elem; /* Node in holder's held_locks. */
+	bool handoff;               /* Hand straight to a waiter on release? */
 };
 
 void lock_init (struct lock *);
+void lock_set_handoff (struct lock *, bool);
 void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
 
+/* Readers-writer lock. */
+struct rwlock {
+	struct lock lock;           /* Held by the writer; readers pass through. */
+	unsigned readers;           /* # of threads holding it for reading. */
+	struct list holds;          /* Readers' struct rwlock_hold. */
+	bool draining;              /* A writer waits for the readers to leave. */
+	struct semaphore drained;   /* Upped by the last reader to leave. */
+};
+
+/* One thread's hold on a readers-writer lock for reading.  LOCK
+   is never acquired: it stands in the reader's held_locks for the
+   hold, so that a writer waiting for the readers to leave donates
+   to each of them the way a lock waiter donates to the holder. */
+struct rwlock_hold {
+	struct lock lock;           /* Carries the donation; holder is the reader. */
+	struct rwlock *rw;          /* Lock held, or NULL if this hold is free. */
+	struct list_elem elem;      /* Element in RW's holds. */
+};
+
+/* Readers-writer locks a thread may hold for reading at once. */
+#define RWLOCK_HOLD_MAX 2
+
+void rwlock_init (struct rwlock *);
+void rwlock_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+void rwlock_donate (struct rwlock *, int priority);
+
+/* Sequence lock. */
+struct seqlock {
+	unsigned sequence;          /* Odd while a write is in progress. */
+	int old_level;              /* Writer's interrupt level to restore. */
+};
+
+void seqlock_init (struct seqlock *);
+unsigned seqlock_read_begin (const struct seqlock *);
+bool seqlock_read_retry (const struct seqlock *, unsigned start);
+void seqlock_write_begin (struct seqlock *);
+void seqlock_write_end (struct seqlock *);
+
 /* Condition variable. */
 struct condition {
-	struct list waiters;        /* List of waiting threads. */
+	struct wait_queue waiters;  /* Waiting threads. */
 };
 
 void cond_init (struct condition *);
@@ -39,10 +102,6 @@ void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
 /* Priority */
-bool compare_thread_priority_desc(struct list_elem *a, struct list_elem *b, void *aux);
-bool compare_local_tick_asc(struct list_elem *a, struct list_elem *b,	void *aux);
-bool compare_sema_priority_desc(struct list_elem *a, struct list_elem *b, void *aux);
-bool compare_donation_priority_desc(struct list_elem *a, struct list_elem *b, void *aux);
 
 /* Optimization barrier.
  *
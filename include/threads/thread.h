@@ -3,8 +3,11 @@
 
 #include <debug.h>
 #include <list.h>
+#include <rbtree.h>
+#include <sched-stats.h>
 #include <stdint.h>
 #include "threads/interrupt.h"
+#include "threads/palloc.h"
 #include "threads/synch.h"
 #ifdef VM
 #include "vm/vm.h"
@@ -29,6 +32,10 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
+/* Thread niceness. */
+#define NICE_MIN -20                    /* Largest share of the CPU. */
+#define NICE_MAX 20                     /* Smallest share of the CPU. */
+
 /* File descriptor for file system */
 #define FD_BASE 2
 #define FD_LIMIT 128
@@ -103,16 +110,44 @@ struct thread {
 	/* Lab #1: Threads - Priority- donation */
 	int init_priority;					/* Priority backup for nested donation */
 	struct lock *waiting_lock;			/* Lock that thread is waiting for */
-	struct list donors;					/* List of donors */
-	struct list_elem donor_elem;		/* List element for donors */
+	struct rb_tree held_locks;			/* Locks held, highest donation first */
+	struct rwlock *draining_rwlock;     /* Rwlock whose readers we wait out. */
+	struct rwlock_hold read_holds[RWLOCK_HOLD_MAX]; /* See synch.c. */
 
 	/* Lab #1 - advanced 구현에 사용*/
 	int nice;
 	int recent_cpu;	
+	int64_t decay_epoch;				/* Last recent_cpu decay epoch applied. */
+
+	/* Deadline (EDF) class; dl_runtime == 0 if not a member. */
+	int64_t dl_runtime;                 /* Budget per period, in ticks. */
+	int64_t dl_deadline;                /* Relative deadline, in ticks. */
+	int64_t dl_period;                  /* Reservation period, in ticks. */
+	int64_t dl_abs_deadline;            /* Current absolute deadline. */
+	int64_t dl_budget;                  /* Budget left until dl_abs_deadline. */
+	bool dl_throttled;                  /* Budget exhausted, waiting for refill. */
+
+	/* Completely fair scheduler. */
+	int64_t vruntime;                   /* Weighted run time, see thread.c. */
+	struct rb_node cfs_node;            /* Node in the CFS run queue. */
+
+	/* CPU bandwidth control. */
+	struct cpu_group *cpu_group;        /* Group charged for this thread's ticks. */
+	bool cpu_parked;                    /* Ready but held back by group quota. */
+
+	/* Scheduling statistics. */
+	struct sched_stats stats;           /* Counters, see thread.c. */
+	int64_t ready_since;                /* timer_ns() when last made ready. */
+	struct list_elem all_elem;          /* Element in all_list. */
+
+	/* Owned by palloc.c. */
+	struct palloc_magazine magazine;    /* Free user pages for reuse. */
 	
 	/* Shared between thread.c and synch.c. */
 	struct list_elem elem;              /* List element. */
 	struct list_elem mlfqs_elem;        /* List element for mlfqs threads list. */
+	struct wait_queue *wait_queue;      /* Wait queue we are blocked in, if any. */
+	struct rb_node wait_node;           /* Node in wait_queue. */
 
 #ifdef USERPROG
 	/* Owned by userprog/process.c. */
@@ -137,6 +172,10 @@ struct thread {
 
 	struct file *exec_file;            /* Executable file */
 
+	uint8_t *fpu_area;                 /* FXSAVE area, NULL until first FPU use. */
+
+	uintptr_t futex_key;               /* Physical address waited on in futex_wait(). */
+
 #endif
 #ifdef VM
 	struct supplemental_page_table spt; 	   /* Table for whole virtual memory owned by thread. */
@@ -144,6 +183,7 @@ struct thread {
 #endif
 
 	/* Owned by thread.c. */
+	uint64_t switch_rsp;                /* Saved stack pointer, 0 if never run. */
 	struct intr_frame tf;               /* Information for switching */
 	unsigned magic;                     /* Detects stack overflow. */
 };
@@ -159,10 +199,20 @@ struct fd_elem {
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, use the completely fair (vruntime) scheduler.
+   Controlled by kernel command-line option "-cfs". */
+extern bool thread_cfs;
+
+/* If true, print each thread's scheduling statistics when it
+   exits and at power off.
+   Controlled by kernel command-line option "-schedstats". */
+extern bool thread_schedstats;
+
 void thread_init (void);
 void thread_start (void);
 
-void thread_tick (void);
+void thread_tick (bool user);
+void thread_tick_idle (int64_t cnt);
 void thread_print_stats (void);
 
 typedef void thread_func (void *aux);
@@ -171,10 +221,9 @@ tid_t thread_create (const char *name, int priority, thread_func *, void *);
 /* Lab #1 - 함수 정의*/
 void thread_sleep (int64_t ticks);
 void thread_wake (int64_t local_tick);
+int64_t thread_next_wakeup (int64_t limit);
 void thread_try_preempt(void);
 
-int64_t get_global_tick(void);
-
 void thread_block (void);
 void thread_unblock (struct thread *);
 
@@ -188,15 +237,21 @@ void thread_yield (void);
 int thread_get_priority (void);
 void thread_set_priority (int);
 void thread_donate_priority (void);
+void thread_donate_to_lock (struct lock *, int priority);
+bool thread_set_deadline (int64_t runtime, int64_t deadline, int64_t period);
+bool thread_set_cpu_max (int64_t quota, int64_t period);
+int64_t thread_get_cpu_throttled (void);
+void thread_get_sched_stats (struct sched_stats *);
 void thread_update_priority (void);
 
 /* Lab 1 - 함수 정의*/
 void advanced_priority_calculation (struct thread *t);
-void advanced_recent_cpu_calculation (struct thread *t);
+void advanced_recent_cpu_calculation (struct thread *t, int coef);
 void advanced_load_avg_calculation (void);
 void advanced_recent_cpu_increase (void);
 void advanced_recent_cpu_update (void);
 void advanced_priority_update (void);
+void advanced_decay_step (void);
 
 int thread_get_nice (void);
 void thread_set_nice (int);
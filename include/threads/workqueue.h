@@ -0,0 +1,33 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+
+/* Work queues run deferred work in kernel worker threads, where,
+   unlike in an interrupt handler or softirq, it may sleep. */
+
+/* Queues, each drained by its own worker thread. */
+enum work_priority {
+	WORK_HIGH,                  /* Ahead of every other thread. */
+	WORK_DEFAULT,               /* Alongside ordinary threads. */
+	WORK_LOW,                   /* Only when nothing else is ready. */
+	WORK_PRIORITY_CNT
+};
+
+typedef void work_func (void *aux);
+
+/* A piece of deferred work.  The caller owns it; the work queue
+   only links it in while it is pending. */
+struct work {
+	struct list_elem elem;      /* List element in the work queue. */
+	work_func *func;            /* Function to run. */
+	void *aux;                  /* Argument for FUNC. */
+	bool pending;               /* Queued and not yet started? */
+};
+
+void workqueue_init (void);
+void work_init (struct work *, work_func *, void *aux);
+bool work_queue (enum work_priority, struct work *);
+
+#endif /* threads/workqueue.h */
@@ -0,0 +1,10 @@
+#ifndef USERPROG_FUTEX_H
+#define USERPROG_FUTEX_H
+
+#include <stdbool.h>
+
+void futex_init (void);
+bool futex_wait (const int *uaddr, int val);
+int futex_wake (const int *uaddr, int cnt);
+
+#endif /* userprog/futex.h */
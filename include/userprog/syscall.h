@@ -7,4 +7,7 @@ void exit_handler (int status);
 
 struct lock file_lock;
 
+/* Cache that struct fd_elem is allocated from. */
+extern struct kmem_cache *fd_elem_cache;
+
 #endif /* userprog/syscall.h */
@@ -31,4 +31,7 @@ struct lazy_load_info {
 	uint32_t zero_bytes;
 	bool writable;
 };
+
+/* Cache that lazy_load_info structures are allocated from. */
+extern struct kmem_cache *lazy_load_info_cache;
 #endif
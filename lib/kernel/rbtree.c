@@ -0,0 +1,298 @@
+#include "rbtree.h"
+#include "../debug.h"
+
+/* Red-black tree, following the algorithms in Cormen et al.,
+   "Introduction to Algorithms", with null pointers standing in
+   for the black leaves. */
+
+static void replace_child (struct rb_tree *, struct rb_node *parent,
+		struct rb_node *old, struct rb_node *new);
+static void rotate_left (struct rb_tree *, struct rb_node *);
+static void rotate_right (struct rb_tree *, struct rb_node *);
+static void insert_fixup (struct rb_tree *, struct rb_node *);
+static void remove_fixup (struct rb_tree *, struct rb_node *,
+		struct rb_node *parent);
+
+/* Returns true if NODE is red.  Null leaves are black. */
+static inline bool
+is_red (const struct rb_node *node) {
+	return node != NULL && node->red;
+}
+
+/* Initializes TREE as an empty tree ordered by LESS given
+   auxiliary data AUX. */
+void
+rb_init (struct rb_tree *tree, rb_less_func *less, void *aux) {
+	ASSERT (tree != NULL);
+	ASSERT (less != NULL);
+
+	tree->root = NULL;
+	tree->leftmost = NULL;
+	tree->less = less;
+	tree->aux = aux;
+}
+
+/* Inserts NODE into TREE.  NODE goes after any nodes that compare
+   equal to it. */
+void
+rb_insert (struct rb_tree *tree, struct rb_node *node) {
+	struct rb_node *parent = NULL;
+	struct rb_node **link = &tree->root;
+	bool leftmost = true;
+
+	ASSERT (tree != NULL);
+	ASSERT (node != NULL);
+
+	while (*link != NULL) {
+		parent = *link;
+		if (tree->less (node, parent, tree->aux))
+			link = &parent->left;
+		else {
+			link = &parent->right;
+			leftmost = false;
+		}
+	}
+
+	node->parent = parent;
+	node->left = node->right = NULL;
+	node->red = true;
+	*link = node;
+	if (leftmost)
+		tree->leftmost = node;
+
+	insert_fixup (tree, node);
+}
+
+/* Removes NODE, which must be in TREE. */
+void
+rb_remove (struct rb_tree *tree, struct rb_node *node) {
+	struct rb_node *child, *parent;
+	bool removed_red;
+
+	ASSERT (tree != NULL);
+	ASSERT (node != NULL);
+
+	if (tree->leftmost == node)
+		tree->leftmost = rb_next (node);
+
+	if (node->left == NULL || node->right == NULL) {
+		/* At most one child: splice NODE out. */
+		child = node->left != NULL ? node->left : node->right;
+		parent = node->parent;
+		removed_red = node->red;
+		replace_child (tree, parent, node, child);
+		if (child != NULL)
+			child->parent = parent;
+	} else {
+		/* Two children: NODE's successor takes its place. */
+		struct rb_node *next = node->right;
+
+		while (next->left != NULL)
+			next = next->left;
+		child = next->right;
+		removed_red = next->red;
+
+		if (next->parent == node)
+			parent = next;
+		else {
+			parent = next->parent;
+			parent->left = child;
+			if (child != NULL)
+				child->parent = parent;
+			next->right = node->right;
+			next->right->parent = next;
+		}
+
+		replace_child (tree, node->parent, node, next);
+		next->parent = node->parent;
+		next->left = node->left;
+		next->left->parent = next;
+		next->red = node->red;
+	}
+
+	if (!removed_red)
+		remove_fixup (tree, child, parent);
+}
+
+/* Returns the smallest node in TREE, or a null pointer if TREE is
+   empty. */
+struct rb_node *
+rb_first (const struct rb_tree *tree) {
+	return tree->leftmost;
+}
+
+/* Returns the node that follows NODE in order, or a null pointer
+   if NODE is the largest. */
+struct rb_node *
+rb_next (const struct rb_node *node) {
+	ASSERT (node != NULL);
+
+	if (node->right != NULL) {
+		node = node->right;
+		while (node->left != NULL)
+			node = node->left;
+		return (struct rb_node *) node;
+	}
+	while (node->parent != NULL && node == node->parent->right)
+		node = node->parent;
+	return node->parent;
+}
+
+/* Returns true if TREE is empty, false otherwise. */
+bool
+rb_empty (const struct rb_tree *tree) {
+	return tree->root == NULL;
+}
+
+/* Makes NEW take OLD's place as a child of PARENT, or as the root
+   of TREE if PARENT is null. */
+static void
+replace_child (struct rb_tree *tree, struct rb_node *parent,
+		struct rb_node *old, struct rb_node *new) {
+	if (parent == NULL)
+		tree->root = new;
+	else if (parent->left == old)
+		parent->left = new;
+	else
+		parent->right = new;
+}
+
+/* Rotates NODE down to the left, lifting its right child. */
+static void
+rotate_left (struct rb_tree *tree, struct rb_node *node) {
+	struct rb_node *right = node->right;
+
+	node->right = right->left;
+	if (right->left != NULL)
+		right->left->parent = node;
+	right->parent = node->parent;
+	replace_child (tree, node->parent, node, right);
+	right->left = node;
+	node->parent = right;
+}
+
+/* Rotates NODE down to the right, lifting its left child. */
+static void
+rotate_right (struct rb_tree *tree, struct rb_node *node) {
+	struct rb_node *left = node->left;
+
+	node->left = left->right;
+	if (left->right != NULL)
+		left->right->parent = node;
+	left->parent = node->parent;
+	replace_child (tree, node->parent, node, left);
+	left->right = node;
+	node->parent = left;
+}
+
+/* Restores the red-black properties after red NODE was added. */
+static void
+insert_fixup (struct rb_tree *tree, struct rb_node *node) {
+	struct rb_node *parent;
+
+	while ((parent = node->parent) != NULL && parent->red) {
+		/* A red parent is never the root, so it has a parent. */
+		struct rb_node *grandparent = parent->parent;
+
+		if (parent == grandparent->left) {
+			struct rb_node *uncle = grandparent->right;
+
+			if (is_red (uncle)) {
+				parent->red = uncle->red = false;
+				grandparent->red = true;
+				node = grandparent;
+				continue;
+			}
+			if (node == parent->right) {
+				rotate_left (tree, parent);
+				node = parent;
+				parent = node->parent;
+			}
+			parent->red = false;
+			grandparent->red = true;
+			rotate_right (tree, grandparent);
+		} else {
+			struct rb_node *uncle = grandparent->left;
+
+			if (is_red (uncle)) {
+				parent->red = uncle->red = false;
+				grandparent->red = true;
+				node = grandparent;
+				continue;
+			}
+			if (node == parent->left) {
+				rotate_right (tree, parent);
+				node = parent;
+				parent = node->parent;
+			}
+			parent->red = false;
+			grandparent->red = true;
+			rotate_left (tree, grandparent);
+		}
+	}
+	tree->root->red = false;
+}
+
+/* Restores the red-black properties after a black node was
+   removed.  NODE, possibly null, now stands where it was, as a
+   child of PARENT, and carries an extra black. */
+static void
+remove_fixup (struct rb_tree *tree, struct rb_node *node,
+		struct rb_node *parent) {
+	while (node != tree->root && !is_red (node)) {
+		if (node == parent->left) {
+			struct rb_node *sibling = parent->right;
+
+			if (sibling->red) {
+				sibling->red = false;
+				parent->red = true;
+				rotate_left (tree, parent);
+				sibling = parent->right;
+			}
+			if (!is_red (sibling->left) && !is_red (sibling->right)) {
+				sibling->red = true;
+				node = parent;
+				parent = node->parent;
+				continue;
+			}
+			if (!is_red (sibling->right)) {
+				sibling->left->red = false;
+				sibling->red = true;
+				rotate_right (tree, sibling);
+				sibling = parent->right;
+			}
+			sibling->red = parent->red;
+			parent->red = false;
+			sibling->right->red = false;
+			rotate_left (tree, parent);
+		} else {
+			struct rb_node *sibling = parent->left;
+
+			if (sibling->red) {
+				sibling->red = false;
+				parent->red = true;
+				rotate_right (tree, parent);
+				sibling = parent->left;
+			}
+			if (!is_red (sibling->left) && !is_red (sibling->right)) {
+				sibling->red = true;
+				node = parent;
+				parent = node->parent;
+				continue;
+			}
+			if (!is_red (sibling->left)) {
+				sibling->right->red = false;
+				sibling->red = true;
+				rotate_left (tree, sibling);
+				sibling = parent->left;
+			}
+			sibling->red = parent->red;
+			parent->red = false;
+			sibling->left->red = false;
+			rotate_right (tree, parent);
+		}
+		node = tree->root;
+	}
+	if (node != NULL)
+		node->red = false;
+}
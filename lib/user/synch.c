@@ -0,0 +1,100 @@
+#include <synch.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <syscall.h>
+
+/* The mutex follows Drepper, "Futexes Are Tricky": its state
+   says whether anyone may be sleeping in the kernel, so that an
+   uncontended lock and unlock are a single atomic instruction
+   each and never make a system call. */
+
+/* Atomically sets *P to NEW if it equals OLD, and returns the
+   value *P had. */
+static inline int
+cmpxchg (int *p, int old, int new) {
+	__atomic_compare_exchange_n (p, &old, new, false,
+			__ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+	return old;
+}
+
+/* Initializes M as unlocked. */
+void
+mutex_init (struct mutex *m) {
+	m->state = 0;
+}
+
+/* Acquires M, sleeping until it is available if necessary. */
+void
+mutex_lock (struct mutex *m) {
+	int c = cmpxchg (&m->state, 0, 1);
+
+	if (c == 0)
+		return;
+
+	/* Contended.  Mark M as having sleepers before each sleep, so
+	   that whoever unlocks it knows to wake us.  If it was free
+	   after all, we got it, but must leave it marked, since other
+	   sleepers may remain. */
+	if (c != 2)
+		c = __atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE);
+	while (c != 0) {
+		futex (&m->state, FUTEX_WAIT, 2);
+		c = __atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE);
+	}
+}
+
+/* Acquires M if it is free and returns true, or returns false
+   without sleeping. */
+bool
+mutex_trylock (struct mutex *m) {
+	return cmpxchg (&m->state, 0, 1) == 0;
+}
+
+/* Releases M, which the caller must hold, and wakes one sleeper
+   if there may be any. */
+void
+mutex_unlock (struct mutex *m) {
+	if (__atomic_fetch_sub (&m->state, 1, __ATOMIC_RELEASE) != 1) {
+		__atomic_store_n (&m->state, 0, __ATOMIC_RELEASE);
+		futex (&m->state, FUTEX_WAKE, 1);
+	}
+}
+
+/* Initializes CV. */
+void
+condvar_init (struct condvar *cv) {
+	cv->seq = 0;
+}
+
+/* Atomically releases M and waits for CV to be signaled, then
+   reacquires M.  M must be held.  As with the kernel's condition
+   variables, wakeups may be spurious, so callers should recheck
+   their condition in a loop. */
+void
+condvar_wait (struct condvar *cv, struct mutex *m) {
+	int seq = __atomic_load_n (&cv->seq, __ATOMIC_RELAXED);
+
+	mutex_unlock (m);
+	/* A signal after the unlock changes SEQ, so the kernel does
+	   not let us sleep through it. */
+	futex (&cv->seq, FUTEX_WAIT, seq);
+
+	/* Others may still be sleeping on M after the broadcast that
+	   woke us, so take it in the contended state. */
+	while (__atomic_exchange_n (&m->state, 2, __ATOMIC_ACQUIRE) != 0)
+		futex (&m->state, FUTEX_WAIT, 2);
+}
+
+/* Wakes one process waiting on CV, if any. */
+void
+condvar_signal (struct condvar *cv) {
+	__atomic_fetch_add (&cv->seq, 1, __ATOMIC_RELEASE);
+	futex (&cv->seq, FUTEX_WAKE, 1);
+}
+
+/* Wakes all processes waiting on CV. */
+void
+condvar_broadcast (struct condvar *cv) {
+	__atomic_fetch_add (&cv->seq, 1, __ATOMIC_RELEASE);
+	futex (&cv->seq, FUTEX_WAKE, INT_MAX);
+}
@@ -194,3 +194,33 @@ int
 umount (const char *path) {
 	return syscall1 (SYS_UMOUNT, path);
 }
+
+bool
+sched_deadline (int runtime, int deadline, int period) {
+	return syscall3 (SYS_SCHED_DEADLINE, runtime, deadline, period);
+}
+
+bool
+cpu_max (int quota, int period) {
+	return syscall2 (SYS_CPU_MAX, quota, period);
+}
+
+long long
+cpu_throttled (void) {
+	return syscall0 (SYS_CPU_THROTTLED);
+}
+
+void
+get_sched_stats (struct sched_stats *stats) {
+	syscall1 (SYS_SCHED_STATS, stats);
+}
+
+int
+futex (int *uaddr, int op, int val) {
+	return syscall3 (SYS_FUTEX, uaddr, op, val);
+}
+
+long long
+clock_ns (void) {
+	return syscall0 (SYS_CLOCK_NS);
+}
@@ -0,0 +1,82 @@
+/* Puts 10,000 threads to sleep for staggered durations and
+   verifies that none of them wakes up early.  Also reports how
+   long the timer keeps interrupts off per tick while all of them
+   are asleep, in its interrupt handler and in the timer softirq's
+   bookkeeping for the tick.
+
+   Each thread holds a page, so the test needs about 40 MB of
+   kernel pool; Make.tests boots it with more memory than the
+   other tests. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 10000
+#define MAX_DURATION 500
+
+static struct semaphore done_sema;
+static struct lock early_lock;
+static int early_cnt;
+
+static void sleeper (void *);
+
+void
+test_alarm_many (void) 
+{
+  uint64_t max_cycles, avg_cycles;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  msg ("Creating %d threads to sleep up to %d ticks each.",
+       THREAD_CNT, MAX_DURATION);
+
+  sema_init (&done_sema, 0);
+  lock_init (&early_lock);
+  early_cnt = 0;
+  timer_intr_stats_reset ();
+
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      int64_t duration = 1 + (i * 7919) % MAX_DURATION;
+      char name[16];
+
+      snprintf (name, sizeof name, "sleeper %d", i);
+      if (thread_create (name, PRI_DEFAULT, sleeper,
+                         (void *) duration) == TID_ERROR)
+        fail ("couldn't create thread %d", i);
+    }
+
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done_sema);
+
+  timer_intr_stats (&max_cycles, &avg_cycles);
+  if (early_cnt != 0)
+    fail ("%d threads woke up early", early_cnt);
+
+  msg ("All %d threads woke up on time.", THREAD_CNT);
+  msg ("Timer interrupt: max %llu cycles, avg %llu cycles per tick.",
+       (unsigned long long) max_cycles, (unsigned long long) avg_cycles);
+}
+
+/* Sleeper thread. */
+static void
+sleeper (void *duration_) 
+{
+  int64_t duration = (int64_t) duration_;
+  int64_t wakeup = timer_ticks () + duration;
+
+  timer_sleep (duration);
+  if (timer_ticks () < wakeup) 
+    {
+      lock_acquire (&early_lock);
+      early_cnt++;
+      lock_release (&early_lock);
+    }
+  sema_up (&done_sema);
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+fail "missing test begin message\n"
+  if !grep (/^\(alarm-many\) begin$/, @output);
+fail "not all threads woke up on time\n"
+  if !grep (/^\(alarm-many\) All 10000 threads woke up on time\.$/, @output);
+fail "missing timer interrupt cost report\n"
+  if !grep (/^\(alarm-many\) Timer interrupt: max \d+ cycles, avg \d+ cycles per tick\.$/, @output);
+fail "missing test end message\n"
+  if !grep (/^\(alarm-many\) end$/, @output);
+pass;
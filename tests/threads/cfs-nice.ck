@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::mlfqs;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+my (@actual);
+foreach (@output) {
+    my ($id, $count) = /Thread (\d+) received (\d+) ticks\./ or next;
+    $actual[$id] = $count;
+}
+
+# Weights of nice 0 and nice 5 over 1000 ticks.
+my (@expected) = (1000 * 1024 / 1359, 1000 * 335 / 1359);
+mlfqs_compare ("thread", "%d", \@actual, \@expected, 50, [0, 1, 1],
+	       "Some tick counts were missing or differed from those "
+	       . "expected by more than 50.");
+pass;
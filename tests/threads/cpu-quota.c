@@ -0,0 +1,63 @@
+/* Starts a thread that limits itself to 2 ticks of CPU time every
+   10 ticks, spins for 100 ticks, and checks that it was kept off
+   the CPU for most of that time and that the throttled time was
+   accounted.  Also checks that once set, the limit can be
+   tightened but not loosened or lifted. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SPIN_TICKS 100
+
+static struct semaphore done_sema;
+
+static void
+limited_thread (void *aux UNUSED) 
+{
+  int64_t start_time, last_time = -1;
+  int run_ticks = 0;
+
+  if (!thread_set_cpu_max (0, 10))
+    msg ("Zero quota rejected.");
+
+  ASSERT (thread_set_cpu_max (4, 10));
+  if (!thread_set_cpu_max (5, 10))
+    msg ("Raising the quota rejected.");
+  if (!thread_set_cpu_max (4, 8))
+    msg ("Shortening the period rejected.");
+  if (!thread_set_cpu_max (-1, 10))
+    msg ("Lifting the limit rejected.");
+  ASSERT (thread_set_cpu_max (2, 10));
+
+  msg ("Spinning for %d ticks with a 2/10 quota.", SPIN_TICKS);
+  start_time = timer_ticks ();
+  while (timer_elapsed (start_time) < SPIN_TICKS) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        run_ticks++;
+      last_time = cur_time;
+    }
+
+  if (run_ticks <= SPIN_TICKS * 4 / 10)
+    msg ("Ran for at most 40%% of the ticks.");
+  else
+    fail ("Ran for %d of %d ticks.", run_ticks, SPIN_TICKS);
+  if (thread_get_cpu_throttled () >= SPIN_TICKS / 2)
+    msg ("Throttled for at least half of the ticks.");
+  else
+    fail ("Throttled for only %lld ticks.", thread_get_cpu_throttled ());
+  sema_up (&done_sema);
+}
+
+void
+test_cpu_quota (void) 
+{
+  sema_init (&done_sema, 0);
+  thread_create ("limited", PRI_DEFAULT, limited_thread, NULL);
+  sema_down (&done_sema);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(cpu-quota) begin
+(cpu-quota) Zero quota rejected.
+(cpu-quota) Raising the quota rejected.
+(cpu-quota) Shortening the period rejected.
+(cpu-quota) Lifting the limit rejected.
+(cpu-quota) Spinning for 100 ticks with a 2/10 quota.
+(cpu-quota) Ran for at most 40% of the ticks.
+(cpu-quota) Throttled for at least half of the ticks.
+(cpu-quota) end
+EOF
+pass;
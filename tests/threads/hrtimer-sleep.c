@@ -0,0 +1,70 @@
+/* Checks that timer_ns() never goes backward, and that sub-tick
+   and multi-tick sleeps block the thread and end within one RTC
+   period plus SLACK_NS of their deadline, well short of the tick
+   boundary a tick-granular sleep would wake up on. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/hrtimer.h"
+#include "devices/timer.h"
+
+/* Allowance for interrupt delivery and the context switch. */
+#define SLACK_NS (NSEC_PER_SEC / 1000)
+
+static volatile bool spinner_stop;
+static volatile int64_t spinner_cnt;
+
+static void
+spinner (void *aux UNUSED) 
+{
+  while (!spinner_stop)
+    spinner_cnt++;
+}
+
+/* Sleeps NS nanoseconds with SLEEP and checks how long it took. */
+static void
+check_sleep (const char *name, void (*sleep) (int64_t), int64_t amount,
+             int64_t ns) 
+{
+  int64_t start, elapsed;
+
+  spinner_cnt = 0;
+  start = timer_ns ();
+  sleep (amount);
+  elapsed = timer_ns () - start;
+
+  if (elapsed < ns)
+    fail ("%s (%lld) returned after only %lld ns.", name, amount, elapsed);
+  else if (elapsed >= ns + HRTIMER_RESOLUTION_NS + SLACK_NS)
+    fail ("%s (%lld) took %lld ns.", name, amount, elapsed);
+  else
+    msg ("%s (%lld) woke up on time.", name, amount);
+  if (spinner_cnt > 0)
+    msg ("%s (%lld) let another thread run.", name, amount);
+  else
+    fail ("%s (%lld) did not block.", name, amount);
+}
+
+void
+test_hrtimer_sleep (void) 
+{
+  int64_t last = timer_ns ();
+  int i;
+
+  for (i = 0; i < 100000; i++) 
+    {
+      int64_t now = timer_ns ();
+      if (now < last)
+        fail ("timer_ns() went back from %lld to %lld.", last, now);
+      last = now;
+    }
+  msg ("timer_ns() never went backward.");
+
+  spinner_stop = false;
+  thread_create ("spinner", PRI_DEFAULT - 1, spinner, NULL);
+  check_sleep ("timer_usleep", timer_usleep, 2000, 2000 * 1000);
+  check_sleep ("timer_msleep", timer_msleep, 25, 25 * 1000 * 1000);
+  spinner_stop = true;
+}
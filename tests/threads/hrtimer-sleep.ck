@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(hrtimer-sleep) begin
+(hrtimer-sleep) timer_ns() never went backward.
+(hrtimer-sleep) timer_usleep (2000) woke up on time.
+(hrtimer-sleep) timer_usleep (2000) let another thread run.
+(hrtimer-sleep) timer_msleep (25) woke up on time.
+(hrtimer-sleep) timer_msleep (25) let another thread run.
+(hrtimer-sleep) end
+EOF
+pass;
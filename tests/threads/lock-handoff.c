@@ -0,0 +1,105 @@
+/* Runs WORKER_CNT threads that take the same lock over and over
+   for about a second, first with a default lock and then with a
+   handoff lock, and reports the acquisitions per second and how
+   evenly they were spread over the threads.
+
+   A worker is often preempted inside its critical section.  With
+   a default lock it usually takes the lock again right after
+   releasing it, before the woken waiter gets to run, so the waiters
+   mostly go back to sleep.  A handoff lock gives the lock to the
+   waiter instead, which should make the split close to even. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define WORKER_CNT 4
+#define WORK_LOOPS 2000
+
+static struct lock hot_lock;
+static struct semaphore done_sema;
+static int64_t end_time;
+static volatile int shared_counter;
+
+static void worker (void *);
+static void run_workers (const char *name, bool handoff);
+static void spin (int loops);
+
+void
+test_lock_handoff (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done_sema, 0);
+  run_workers ("default", false);
+  run_workers ("handoff", true);
+}
+
+/* Runs WORKER_CNT workers on a fresh lock in HANDOFF mode for
+   TIMER_FREQ ticks and reports the results under NAME. */
+static void
+run_workers (const char *name, bool handoff) 
+{
+  int acquired[WORKER_CNT];
+  int64_t start, elapsed, total = 0, sum_sq = 0;
+  int i;
+
+  lock_init (&hot_lock);
+  lock_set_handoff (&hot_lock, handoff);
+
+  start = timer_ticks ();
+  end_time = start + TIMER_FREQ;
+  for (i = 0; i < WORKER_CNT; i++) 
+    {
+      char thread_name[16];
+
+      acquired[i] = 0;
+      snprintf (thread_name, sizeof thread_name, "%s %d", name, i);
+      thread_create (thread_name, PRI_DEFAULT, worker, &acquired[i]);
+    }
+  for (i = 0; i < WORKER_CNT; i++)
+    sema_down (&done_sema);
+  elapsed = timer_ticks () - start;
+
+  for (i = 0; i < WORKER_CNT; i++) 
+    {
+      total += acquired[i];
+      sum_sq += (int64_t) acquired[i] * acquired[i];
+    }
+
+  /* Jain's fairness index, (sum x)^2 / (n * sum x^2), is 1 when
+     every worker got the same share and 1/n when one got it all.
+     Reported in thousandths. */
+  msg ("%s: %lld acquisitions/s, fairness %lld/1000.", name,
+       elapsed > 0 ? total * TIMER_FREQ / elapsed : total,
+       sum_sq > 0 ? total * total * 1000 / (WORKER_CNT * sum_sq) : 0);
+}
+
+static void
+worker (void *acquired_) 
+{
+  int *acquired = acquired_;
+
+  while (timer_ticks () < end_time) 
+    {
+      lock_acquire (&hot_lock);
+      spin (WORK_LOOPS);
+      lock_release (&hot_lock);
+      (*acquired)++;
+      spin (WORK_LOOPS / 4);
+    }
+  sema_up (&done_sema);
+}
+
+/* Does LOOPS iterations of busy work. */
+static void
+spin (int loops) 
+{
+  int i;
+
+  for (i = 0; i < loops; i++)
+    shared_counter++;
+}
@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+fail "missing test begin message\n"
+  if !grep (/^\(lock-handoff\) begin$/, @output);
+fail "missing default lock report\n"
+  if !grep (/^\(lock-handoff\) default: \d+ acquisitions\/s, fairness \d+\/1000\.$/, @output);
+
+my ($fairness) = map (/^\(lock-handoff\) handoff: \d+ acquisitions\/s, fairness (\d+)\/1000\.$/, @output);
+fail "missing handoff lock report\n" if !defined $fairness;
+fail "handoff lock fairness $fairness/1000 is below 900/1000\n"
+  if $fairness < 900;
+
+fail "missing test end message\n"
+  if !grep (/^\(lock-handoff\) end$/, @output);
+pass;
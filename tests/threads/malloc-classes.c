@@ -0,0 +1,94 @@
+/* Allocates blocks of sizes between the size classes, from a few
+   bytes up to past the largest class, and checks that they do not
+   overlap, then checks which reallocations happen in place. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+
+#define BLOCK_CNT 24
+
+static uint8_t *blocks[BLOCK_CNT];
+static size_t sizes[BLOCK_CNT];
+
+/* Returns true if every byte of the SIZE bytes at P is FILL. */
+static bool
+is_filled (const uint8_t *p, size_t size, uint8_t fill) 
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    if (p[i] != fill)
+      return false;
+  return true;
+}
+
+void
+test_malloc_classes (void) 
+{
+  uint8_t *p, *q;
+  int i;
+
+  /* Sizes grow by about 1.5x, from 7 bytes to about 92 kB. */
+  for (i = 0; i < BLOCK_CNT; i++)
+    {
+      sizes[i] = i == 0 ? 7 : sizes[i - 1] * 3 / 2 + 1;
+      blocks[i] = malloc (sizes[i]);
+      if (blocks[i] == NULL)
+        fail ("allocating %zu bytes failed", sizes[i]);
+      memset (blocks[i], i, sizes[i]);
+    }
+  for (i = 0; i < BLOCK_CNT; i++)
+    if (!is_filled (blocks[i], sizes[i], i))
+      fail ("%zu-byte block overwritten", sizes[i]);
+  msg ("Blocks of %zu to %zu bytes do not overlap.",
+       sizes[0], sizes[BLOCK_CNT - 1]);
+  for (i = 0; i < BLOCK_CNT; i++)
+    free (blocks[i]);
+
+  /* 2100 bytes come from the 2560-byte class, so growing to
+     2500 bytes fits in place. */
+  p = malloc (2100);
+  memset (p, 0x5a, 2100);
+  q = realloc (p, 2500);
+  if (q == p)
+    msg ("Growing within the size class stays in place.");
+  if (!is_filled (q, 2100, 0x5a))
+    fail ("contents lost growing in place");
+
+  /* Growing past the class moves the block. */
+  p = realloc (q, 40000);
+  if (p == NULL || !is_filled (p, 2100, 0x5a))
+    fail ("contents lost growing to 40000 bytes");
+  msg ("Growing past the size class keeps the contents.");
+
+  /* Shrinking a big block gives back pages in place. */
+  q = realloc (p, 200000);
+  if (q == NULL || !is_filled (q, 2100, 0x5a))
+    fail ("contents lost growing to 200000 bytes");
+  p = realloc (q, 100000);
+  if (p == q)
+    msg ("Shrinking a big block stays in place.");
+
+  /* The pages it gave back are still free, so it can take them
+     again. */
+  q = realloc (p, 200000);
+  if (q == p)
+    msg ("Growing a big block into free pages stays in place.");
+  if (!is_filled (q, 2100, 0x5a))
+    fail ("contents lost growing a big block");
+  free (q);
+
+  /* Shrinking into a smaller class moves the block. */
+  p = malloc (2560);
+  memset (p, 0xa5, 2560);
+  q = realloc (p, 1300);
+  if (q != p)
+    msg ("Shrinking to a smaller size class moves the block.");
+  if (!is_filled (q, 1300, 0xa5))
+    fail ("contents lost shrinking to a smaller class");
+  free (q);
+}
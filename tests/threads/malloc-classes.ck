@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(malloc-classes) begin
+(malloc-classes) Blocks of 7 to 92168 bytes do not overlap.
+(malloc-classes) Growing within the size class stays in place.
+(malloc-classes) Growing past the size class keeps the contents.
+(malloc-classes) Shrinking a big block stays in place.
+(malloc-classes) Growing a big block into free pages stays in place.
+(malloc-classes) Shrinking to a smaller size class moves the block.
+(malloc-classes) end
+EOF
+pass;
@@ -0,0 +1,76 @@
+/* Allocates batches of user pages, with and without PAL_ZERO,
+   then churns single user pages through the running thread's
+   magazine, checking that no page is handed out twice and that
+   PAL_ZERO pages come back zeroed. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+#define BATCH_CNT 40
+#define CHURN_CNT 100
+
+static void *pages[BATCH_CNT];
+
+/* Fills each of the CNT pages in PAGES with its own index, then
+   checks that they all still hold it. */
+static void
+check_distinct (size_t cnt) 
+{
+  size_t i, j;
+
+  for (i = 0; i < cnt; i++)
+    memset (pages[i], i, PGSIZE);
+  for (i = 0; i < cnt; i++)
+    for (j = 0; j < PGSIZE; j++)
+      if (((uint8_t *) pages[i])[j] != (uint8_t) i)
+        fail ("page %zu overwritten", i);
+}
+
+void
+test_palloc_batch (void) 
+{
+  size_t i, j;
+
+  if (palloc_get_batch (PAL_USER | PAL_ZERO, pages, BATCH_CNT) != BATCH_CNT)
+    fail ("allocating a batch of %d pages failed", BATCH_CNT);
+  for (i = 0; i < BATCH_CNT; i++)
+    for (j = 0; j < PGSIZE; j++)
+      if (((uint8_t *) pages[i])[j] != 0)
+        fail ("page %zu not zeroed", i);
+  check_distinct (BATCH_CNT);
+  palloc_free_batch (pages, BATCH_CNT);
+  msg ("A zeroed batch of %d pages does not overlap.", BATCH_CNT);
+
+  if (palloc_get_batch (PAL_USER, pages, BATCH_CNT) != BATCH_CNT)
+    fail ("allocating a batch of %d pages failed", BATCH_CNT);
+  check_distinct (BATCH_CNT);
+  msg ("A second batch of %d pages does not overlap.", BATCH_CNT);
+
+  /* Free and reallocate single pages in a rotating pattern, so
+     they pass through the magazine in and out of order. */
+  for (i = 0; i < CHURN_CNT; i++)
+    {
+      size_t k = (i * 7) % BATCH_CNT;
+
+      palloc_free_page (pages[k]);
+      pages[k] = palloc_get_page (i % 2 ? PAL_USER | PAL_ZERO : PAL_USER);
+      if (pages[k] == NULL)
+        fail ("allocating a single page failed");
+      if (i % 2)
+        for (j = 0; j < PGSIZE; j++)
+          if (((uint8_t *) pages[k])[j] != 0)
+            fail ("single page not zeroed");
+    }
+  check_distinct (BATCH_CNT);
+  msg ("%d single pages through the magazine do not overlap.", CHURN_CNT);
+
+  for (i = 0; i < BATCH_CNT; i++)
+    palloc_free_page (pages[i]);
+  palloc_flush_magazine ();
+  msg ("Freed every page.");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(palloc-batch) begin
+(palloc-batch) A zeroed batch of 40 pages does not overlap.
+(palloc-batch) A second batch of 40 pages does not overlap.
+(palloc-batch) 100 single pages through the magazine do not overlap.
+(palloc-batch) Freed every page.
+(palloc-batch) end
+EOF
+pass;
@@ -0,0 +1,67 @@
+/* Allocates blocks of 1 to BLOCK_CNT pages, some of them twice
+   over after freeing the first round in a scattered order, and
+   checks that no block overlaps another and that PAL_ZERO blocks
+   come back zeroed. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+#define BLOCK_CNT 16
+
+static uint8_t *blocks[BLOCK_CNT + 1];
+
+/* Allocates a block of PAGE_CNT pages and fills it with PAGE_CNT. */
+static void
+alloc_block (size_t page_cnt) 
+{
+  size_t i;
+
+  blocks[page_cnt] = palloc_get_multiple (PAL_ZERO, page_cnt);
+  if (blocks[page_cnt] == NULL)
+    fail ("allocating %zu pages failed", page_cnt);
+  for (i = 0; i < page_cnt * PGSIZE; i++)
+    if (blocks[page_cnt][i] != 0)
+      fail ("%zu-page block not zeroed", page_cnt);
+  memset (blocks[page_cnt], page_cnt, page_cnt * PGSIZE);
+}
+
+/* Checks that every block still holds its own fill byte. */
+static void
+check_blocks (void) 
+{
+  size_t page_cnt, i;
+
+  for (page_cnt = 1; page_cnt <= BLOCK_CNT; page_cnt++)
+    for (i = 0; i < page_cnt * PGSIZE; i++)
+      if (blocks[page_cnt][i] != page_cnt)
+        fail ("%zu-page block overwritten", page_cnt);
+}
+
+void
+test_palloc_buddy (void) 
+{
+  size_t page_cnt;
+
+  for (page_cnt = 1; page_cnt <= BLOCK_CNT; page_cnt++)
+    alloc_block (page_cnt);
+  check_blocks ();
+  msg ("Blocks of 1 to %d pages do not overlap.", BLOCK_CNT);
+
+  /* Free every third block, then allocate them again so they
+     reuse the split and merged space. */
+  for (page_cnt = 1; page_cnt <= BLOCK_CNT; page_cnt += 3)
+    palloc_free_multiple (blocks[page_cnt], page_cnt);
+  for (page_cnt = 1; page_cnt <= BLOCK_CNT; page_cnt += 3)
+    alloc_block (page_cnt);
+  check_blocks ();
+  msg ("Reallocated blocks do not overlap.");
+
+  for (page_cnt = 1; page_cnt <= BLOCK_CNT; page_cnt++)
+    palloc_free_multiple (blocks[page_cnt], page_cnt);
+  msg ("Freed every block.");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(palloc-buddy) begin
+(palloc-buddy) Blocks of 1 to 16 pages do not overlap.
+(palloc-buddy) Reallocated blocks do not overlap.
+(palloc-buddy) Freed every block.
+(palloc-buddy) end
+EOF
+pass;
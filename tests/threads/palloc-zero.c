@@ -0,0 +1,50 @@
+/* Allocates more PAL_ZERO pages than the pre-zeroed pool holds,
+   dirties and frees them, sleeps so the pool is refilled from
+   the dirty pages, and allocates them again, checking that every
+   page comes back zeroed both times. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+#include "devices/timer.h"
+
+#define PAGE_CNT 200
+
+static uint8_t *pages[PAGE_CNT];
+
+/* Allocates PAGE_CNT zeroed pages, checks them, fills them with
+   FILL and frees them again. */
+static void
+dirty_pages (int fill) 
+{
+  size_t i, j;
+
+  for (i = 0; i < PAGE_CNT; i++)
+    {
+      pages[i] = palloc_get_page (PAL_ZERO);
+      if (pages[i] == NULL)
+        fail ("allocating page %zu failed", i);
+      for (j = 0; j < PGSIZE; j++)
+        if (pages[i][j] != 0)
+          fail ("page %zu not zeroed", i);
+      memset (pages[i], fill, PGSIZE);
+    }
+  for (i = 0; i < PAGE_CNT; i++)
+    palloc_free_page (pages[i]);
+}
+
+void
+test_palloc_zero (void) 
+{
+  dirty_pages (0x5a);
+  msg ("All %d pages read as zero.", PAGE_CNT);
+
+  /* Let the low-priority worker zero the freed pages. */
+  timer_sleep (10);
+  dirty_pages (0xa5);
+  msg ("All %d pages read as zero after the refill.", PAGE_CNT);
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(palloc-zero) begin
+(palloc-zero) All 200 pages read as zero.
+(palloc-zero) All 200 pages read as zero after the refill.
+(palloc-zero) end
+EOF
+pass;
@@ -0,0 +1,63 @@
+/* The main thread holds an rwlock for reading when a
+   higher-priority writer blocks waiting for it, so the writer
+   donates its priority to the main thread.  A medium-priority
+   spinner created next must not run until the main thread has
+   released the lock and the writer has finished with it. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func writer_thread_func;
+static thread_func spinner_thread_func;
+
+static struct rwlock rw;
+static volatile bool writer_done;
+
+void
+test_rwlock_donate (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rw);
+  writer_done = false;
+  rwlock_acquire_read (&rw);
+  msg ("Main thread holds the lock for reading.");
+  thread_create ("writer", PRI_DEFAULT + 10, writer_thread_func, NULL);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 10, thread_get_priority ());
+  thread_create ("spinner", PRI_DEFAULT + 5, spinner_thread_func, NULL);
+  msg ("Main thread releases the lock.");
+  rwlock_release_read (&rw);
+  msg ("This thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT, thread_get_priority ());
+}
+
+static void
+writer_thread_func (void *aux UNUSED) 
+{
+  rwlock_acquire_write (&rw);
+  msg ("Writer acquired the lock.");
+  writer_done = true;
+  rwlock_release_write (&rw);
+  msg ("Writer done.");
+}
+
+static void
+spinner_thread_func (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < 1000000 && !writer_done; i++)
+    barrier ();
+  if (writer_done)
+    msg ("Spinner ran after the writer.");
+  else
+    fail ("Spinner ran before the writer.");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-donate) begin
+(rwlock-donate) Main thread holds the lock for reading.
+(rwlock-donate) This thread should have priority 41.  Actual priority: 41.
+(rwlock-donate) Main thread releases the lock.
+(rwlock-donate) Writer acquired the lock.
+(rwlock-donate) Writer done.
+(rwlock-donate) Spinner ran after the writer.
+(rwlock-donate) This thread should have priority 31.  Actual priority: 31.
+(rwlock-donate) end
+EOF
+pass;
@@ -0,0 +1,154 @@
+/* Runs READER_CNT threads that each enter a read-side critical
+   section READ_CNT times and yield the CPU inside it, first under
+   a plain lock and then under a readers-writer lock, and reports
+   the cost per read and how many readers were inside at once.
+   Then measures seqlock reads against a writer that keeps
+   updating a pair of values, checking that no read saw a torn
+   update. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define READER_CNT 8
+#define READ_CNT 1000
+#define SEQ_READ_CNT 100000
+
+static struct lock plain_lock;
+static struct rwlock rw_lock;
+static struct semaphore done_sema;
+static int inside, max_inside;
+
+static struct seqlock pair_seqlock;
+static int64_t pair_a, pair_b;
+static volatile bool writer_stop;
+
+static void lock_reader (void *);
+static void rwlock_reader (void *);
+static void pair_writer (void *);
+static uint64_t run_readers (const char *name, thread_func *);
+
+void
+test_rwlock_readers (void) 
+{
+  uint64_t start, cycles;
+  int torn = 0;
+  int i;
+
+  lock_init (&plain_lock);
+  rwlock_init (&rw_lock);
+  sema_init (&done_sema, 0);
+
+  cycles = run_readers ("lock", lock_reader);
+  msg ("lock: %d readers at once, %llu cycles per read.", max_inside,
+       (unsigned long long) (cycles / (READER_CNT * READ_CNT)));
+  cycles = run_readers ("rwlock", rwlock_reader);
+  msg ("rwlock: %d readers at once, %llu cycles per read.", max_inside,
+       (unsigned long long) (cycles / (READER_CNT * READ_CNT)));
+
+  seqlock_init (&pair_seqlock);
+  writer_stop = false;
+  thread_create ("writer", PRI_DEFAULT, pair_writer, NULL);
+  start = rdtsc ();
+  for (i = 0; i < SEQ_READ_CNT; i++) 
+    {
+      int64_t a, b;
+      unsigned seq;
+
+      do 
+        {
+          seq = seqlock_read_begin (&pair_seqlock);
+          a = pair_a;
+          b = pair_b;
+        }
+      while (seqlock_read_retry (&pair_seqlock, seq));
+      if (a != b)
+        torn++;
+    }
+  cycles = rdtsc () - start;
+  writer_stop = true;
+  sema_down (&done_sema);
+
+  if (torn == 0)
+    msg ("seqlock: no torn reads.");
+  else
+    fail ("seqlock: %d torn reads.", torn);
+  msg ("seqlock: %llu cycles per read.",
+       (unsigned long long) (cycles / SEQ_READ_CNT));
+}
+
+/* Starts READER_CNT threads running READER, waits for all of them
+   and returns the elapsed TSC cycles. */
+static uint64_t
+run_readers (const char *name, thread_func *reader) 
+{
+  uint64_t start = rdtsc ();
+  int i;
+
+  inside = max_inside = 0;
+  for (i = 0; i < READER_CNT; i++) 
+    {
+      char thread_name[16];
+
+      snprintf (thread_name, sizeof thread_name, "%s %d", name, i);
+      thread_create (thread_name, PRI_DEFAULT, reader, NULL);
+    }
+  for (i = 0; i < READER_CNT; i++)
+    sema_down (&done_sema);
+  return rdtsc () - start;
+}
+
+/* Notes that the running thread entered a read-side section and
+   lets the other readers run. */
+static void
+read_section (void) 
+{
+  if (++inside > max_inside)
+    max_inside = inside;
+  thread_yield ();
+  inside--;
+}
+
+static void
+lock_reader (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < READ_CNT; i++) 
+    {
+      lock_acquire (&plain_lock);
+      read_section ();
+      lock_release (&plain_lock);
+    }
+  sema_up (&done_sema);
+}
+
+static void
+rwlock_reader (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < READ_CNT; i++) 
+    {
+      rwlock_acquire_read (&rw_lock);
+      read_section ();
+      rwlock_release_read (&rw_lock);
+    }
+  sema_up (&done_sema);
+}
+
+static void
+pair_writer (void *aux UNUSED) 
+{
+  while (!writer_stop) 
+    {
+      seqlock_write_begin (&pair_seqlock);
+      pair_a++;
+      pair_b++;
+      seqlock_write_end (&pair_seqlock);
+      thread_yield ();
+    }
+  sema_up (&done_sema);
+}
@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+fail "missing test begin message\n"
+  if !grep (/^\(rwlock-readers\) begin$/, @output);
+fail "lock let more than one reader in\n"
+  if !grep (/^\(rwlock-readers\) lock: 1 readers at once, \d+ cycles per read\.$/, @output);
+fail "rwlock did not let every reader in at once\n"
+  if !grep (/^\(rwlock-readers\) rwlock: 8 readers at once, \d+ cycles per read\.$/, @output);
+fail "seqlock returned a torn read\n"
+  if !grep (/^\(rwlock-readers\) seqlock: no torn reads\.$/, @output);
+fail "missing seqlock cost report\n"
+  if !grep (/^\(rwlock-readers\) seqlock: \d+ cycles per read\.$/, @output);
+fail "missing test end message\n"
+  if !grep (/^\(rwlock-readers\) end$/, @output);
+pass;
@@ -0,0 +1,47 @@
+/* Checks admission control for the deadline class, then puts the
+   main thread in it and verifies that a PRI_MAX thread cannot
+   preempt it until the main thread has spent its budget and been
+   throttled. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+
+static void hog_thread (void *);
+
+static volatile bool hog_ran;
+
+void
+test_sched_edf (void) 
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  if (!thread_set_deadline (10, 10, 10))
+    msg ("Reservation of the whole CPU rejected.");
+  if (!thread_set_deadline (5, 4, 10))
+    msg ("Runtime beyond the deadline rejected.");
+  if (thread_set_deadline (5, 10, 10) && thread_set_deadline (9, 10, 10))
+    msg ("Reservation of 90%% admitted and resized.");
+
+  ASSERT (thread_set_deadline (3, 10, 10));
+  hog_ran = false;
+  thread_create ("hog", PRI_MAX, hog_thread, NULL);
+  if (!hog_ran)
+    msg ("EDF thread kept the CPU after creating a PRI_MAX thread.");
+
+  /* Spin until the budget runs out and the hog gets its turn. */
+  while (!hog_ran)
+    continue;
+  msg ("PRI_MAX thread ran once the EDF budget was used up.");
+
+  ASSERT (thread_set_deadline (0, 0, 0));
+  msg ("Left the deadline class.");
+}
+
+static void
+hog_thread (void *aux UNUSED) 
+{
+  hog_ran = true;
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sched-edf) begin
+(sched-edf) Reservation of the whole CPU rejected.
+(sched-edf) Runtime beyond the deadline rejected.
+(sched-edf) Reservation of 90% admitted and resized.
+(sched-edf) EDF thread kept the CPU after creating a PRI_MAX thread.
+(sched-edf) PRI_MAX thread ran once the EDF budget was used up.
+(sched-edf) Left the deadline class.
+(sched-edf) end
+EOF
+pass;
@@ -0,0 +1,56 @@
+/* Checks that the running thread's scheduling statistics count
+   the wakeup and voluntary switch of a sleep, the involuntary
+   switch and run delay of a yield to a busy thread, and the
+   kernel ticks of a busy wait. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static void
+busy_thread (void *aux UNUSED) 
+{
+  int64_t start = timer_ticks ();
+
+  while (timer_elapsed (start) < 1)
+    continue;
+}
+
+void
+test_sched_stats (void) 
+{
+  struct sched_stats before, after;
+  int64_t start;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  thread_get_sched_stats (&before);
+  timer_sleep (1);
+  thread_get_sched_stats (&after);
+  if (after.wakeups > before.wakeups)
+    msg ("Sleeping counts a wakeup.");
+  if (after.voluntary_switches > before.voluntary_switches)
+    msg ("Sleeping counts a voluntary switch.");
+
+  before = after;
+  thread_create ("busy", PRI_DEFAULT, busy_thread, NULL);
+  thread_yield ();
+  thread_get_sched_stats (&after);
+  if (after.involuntary_switches > before.involuntary_switches)
+    msg ("Yielding counts an involuntary switch.");
+  if (after.run_delay > before.run_delay)
+    msg ("Waiting behind another thread counts run delay.");
+
+  before = after;
+  start = timer_ticks ();
+  while (timer_elapsed (start) < 2)
+    continue;
+  thread_get_sched_stats (&after);
+  if (after.kernel_ticks > before.kernel_ticks)
+    msg ("Spinning counts kernel ticks.");
+  if (after.user_ticks == 0)
+    msg ("A kernel thread has no user ticks.");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sched-stats) begin
+(sched-stats) Sleeping counts a wakeup.
+(sched-stats) Sleeping counts a voluntary switch.
+(sched-stats) Yielding counts an involuntary switch.
+(sched-stats) Waiting behind another thread counts run delay.
+(sched-stats) Spinning counts kernel ticks.
+(sched-stats) A kernel thread has no user ticks.
+(sched-stats) end
+EOF
+pass;
@@ -0,0 +1,75 @@
+/* Allocates enough objects from a cache with a constructor to
+   fill several slabs, and checks that they do not overlap, that
+   each was constructed, and that freed objects come back still
+   constructed. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/slab.h"
+
+#define OBJ_CNT 200
+
+/* A 90-byte object, which malloc() would put in a 128-byte
+   block. */
+struct obj {
+  int magic;
+  uint8_t fill[86];
+};
+
+#define OBJ_MAGIC 0x0b1ec7ed
+
+static struct obj *objs[OBJ_CNT];
+static int ctor_cnt;
+
+static void
+obj_ctor (void *obj_) 
+{
+  struct obj *obj = obj_;
+
+  obj->magic = OBJ_MAGIC;
+  ctor_cnt++;
+}
+
+void
+test_slab_cache (void) 
+{
+  struct kmem_cache *cache;
+  int i, j;
+
+  cache = kmem_cache_create ("test-obj", sizeof (struct obj), obj_ctor);
+  if (cache == NULL)
+    fail ("kmem_cache_create failed");
+
+  for (i = 0; i < OBJ_CNT; i++)
+    {
+      objs[i] = kmem_cache_alloc (cache);
+      if (objs[i] == NULL)
+        fail ("allocating object %d failed", i);
+      if (objs[i]->magic != OBJ_MAGIC)
+        fail ("object %d not constructed", i);
+      memset (objs[i]->fill, i, sizeof objs[i]->fill);
+    }
+  for (i = 0; i < OBJ_CNT; i++)
+    for (j = 0; j < (int) sizeof objs[i]->fill; j++)
+      if (objs[i]->fill[j] != (uint8_t) i)
+        fail ("object %d overwritten", i);
+  msg ("%d objects do not overlap.", OBJ_CNT);
+  if (ctor_cnt >= OBJ_CNT)
+    msg ("Every object was constructed.");
+
+  for (i = 0; i < OBJ_CNT; i += 2)
+    kmem_cache_free (cache, objs[i]);
+  for (i = 0; i < OBJ_CNT; i += 2)
+    {
+      objs[i] = kmem_cache_alloc (cache);
+      if (objs[i] == NULL || objs[i]->magic != OBJ_MAGIC)
+        fail ("reallocated object %d not constructed", i);
+    }
+  msg ("Freed objects come back constructed.");
+
+  for (i = 0; i < OBJ_CNT; i++)
+    kmem_cache_free (cache, objs[i]);
+}
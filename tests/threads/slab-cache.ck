@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(slab-cache) begin
+(slab-cache) 200 objects do not overlap.
+(slab-cache) Every object was constructed.
+(slab-cache) Freed objects come back constructed.
+(slab-cache) end
+EOF
+pass;
@@ -0,0 +1,54 @@
+/* Bounces control back and forth between two threads of equal
+   priority with a pair of semaphores, and reports the mean cost
+   of one context switch in TSC cycles. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define ROUND_TRIPS 10000
+
+static struct semaphore ping_sema, pong_sema;
+
+static void ponger (void *);
+
+void
+test_switch_pingpong (void) 
+{
+  uint64_t start, cycles;
+  int i;
+
+  msg ("Bouncing between two threads %d times.", ROUND_TRIPS);
+
+  sema_init (&ping_sema, 0);
+  sema_init (&pong_sema, 0);
+  thread_create ("ponger", PRI_DEFAULT, ponger, NULL);
+
+  /* Each round trip blocks this thread once and the ponger once,
+     so it takes two switches. */
+  start = rdtsc ();
+  for (i = 0; i < ROUND_TRIPS; i++) 
+    {
+      sema_up (&ping_sema);
+      sema_down (&pong_sema);
+    }
+  cycles = rdtsc () - start;
+
+  msg ("Ponger answered every ping.");
+  msg ("%d switches, %llu cycles per switch.", ROUND_TRIPS * 2,
+       (unsigned long long) (cycles / (ROUND_TRIPS * 2)));
+}
+
+static void
+ponger (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < ROUND_TRIPS; i++) 
+    {
+      sema_down (&ping_sema);
+      sema_up (&pong_sema);
+    }
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+fail "missing test begin message\n"
+  if !grep (/^\(switch-pingpong\) begin$/, @output);
+fail "ping-pong did not complete\n"
+  if !grep (/^\(switch-pingpong\) Ponger answered every ping\.$/, @output);
+fail "missing switch cost report\n"
+  if !grep (/^\(switch-pingpong\) 20000 switches, \d+ cycles per switch\.$/, @output);
+fail "missing test end message\n"
+  if !grep (/^\(switch-pingpong\) end$/, @output);
+pass;
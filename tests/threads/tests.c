@@ -13,10 +13,12 @@ static const struct test tests[] =
   {
     {"alarm-single", test_alarm_single},
     {"alarm-multiple", test_alarm_multiple},
+    {"alarm-multiple-nohz", test_alarm_multiple},
     {"alarm-simultaneous", test_alarm_simultaneous},
     {"alarm-priority", test_alarm_priority},
     {"alarm-zero", test_alarm_zero},
     {"alarm-negative", test_alarm_negative},
+    {"alarm-many", test_alarm_many},
     {"priority-change", test_priority_change},
     {"priority-donate-one", test_priority_donate_one},
     {"priority-donate-multiple", test_priority_donate_multiple},
@@ -29,7 +31,24 @@ static const struct test tests[] =
     {"priority-preempt", test_priority_preempt},
     {"priority-sema", test_priority_sema},
     {"priority-condvar", test_priority_condvar},
+    {"switch-pingpong", test_switch_pingpong},
+    {"sched-edf", test_sched_edf},
+    {"cfs-nice", test_cfs_nice},
+    {"cpu-quota", test_cpu_quota},
+    {"rwlock-readers", test_rwlock_readers},
+    {"rwlock-donate", test_rwlock_donate},
+    {"lock-handoff", test_lock_handoff},
+    {"workqueue", test_workqueue},
+    {"hrtimer-sleep", test_hrtimer_sleep},
+    {"thread-churn", test_thread_churn},
+    {"sched-stats", test_sched_stats},
+    {"palloc-buddy", test_palloc_buddy},
+    {"slab-cache", test_slab_cache},
+    {"malloc-classes", test_malloc_classes},
+    {"palloc-zero", test_palloc_zero},
+    {"palloc-batch", test_palloc_batch},
     {"mlfqs-load-1", test_mlfqs_load_1},
+    {"mlfqs-load-1-nohz", test_mlfqs_load_1},
     {"mlfqs-load-60", test_mlfqs_load_60},
     {"mlfqs-load-avg", test_mlfqs_load_avg},
     {"mlfqs-recent-1", test_mlfqs_recent_1},
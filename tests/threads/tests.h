@@ -11,6 +11,7 @@ extern test_func test_alarm_simultaneous;
 extern test_func test_alarm_priority;
 extern test_func test_alarm_zero;
 extern test_func test_alarm_negative;
+extern test_func test_alarm_many;
 extern test_func test_priority_change;
 extern test_func test_priority_donate_one;
 extern test_func test_priority_donate_multiple;
@@ -23,6 +24,22 @@ extern test_func test_priority_fifo;
 extern test_func test_priority_preempt;
 extern test_func test_priority_sema;
 extern test_func test_priority_condvar;
+extern test_func test_switch_pingpong;
+extern test_func test_sched_edf;
+extern test_func test_cfs_nice;
+extern test_func test_cpu_quota;
+extern test_func test_rwlock_readers;
+extern test_func test_rwlock_donate;
+extern test_func test_lock_handoff;
+extern test_func test_workqueue;
+extern test_func test_hrtimer_sleep;
+extern test_func test_thread_churn;
+extern test_func test_sched_stats;
+extern test_func test_palloc_buddy;
+extern test_func test_slab_cache;
+extern test_func test_malloc_classes;
+extern test_func test_palloc_zero;
+extern test_func test_palloc_batch;
 extern test_func test_mlfqs_load_1;
 extern test_func test_mlfqs_load_60;
 extern test_func test_mlfqs_load_avg;
@@ -0,0 +1,52 @@
+/* Creates CHURN_CNT short-lived threads one after another, each
+   of which exits right away, and reports the cost of a thread
+   create and exit. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+#include "intrinsic.h"
+
+#define CHURN_CNT 2000
+
+static struct semaphore started;
+
+static void
+churn_thread (void *aux UNUSED) 
+{
+  sema_up (&started);
+}
+
+void
+test_thread_churn (void) 
+{
+  uint64_t start_tsc, cycles;
+  int64_t start_ns, elapsed_ns;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&started, 0);
+  start_tsc = rdtsc ();
+  start_ns = timer_ns ();
+  for (i = 0; i < CHURN_CNT; i++) 
+    {
+      /* A higher priority lets the new thread run and exit before
+         we create the next one. */
+      if (thread_create ("churn", PRI_DEFAULT + 1, churn_thread, NULL)
+          == TID_ERROR)
+        fail ("thread_create failed after %d threads.", i);
+      sema_down (&started);
+    }
+  cycles = rdtsc () - start_tsc;
+  elapsed_ns = timer_ns () - start_ns;
+
+  msg ("Created and exited %d threads.", CHURN_CNT);
+  msg ("%llu cycles per thread, %lld threads/s.",
+       (unsigned long long) (cycles / CHURN_CNT),
+       elapsed_ns > 0 ? CHURN_CNT * NSEC_PER_SEC / elapsed_ns : 0);
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+fail "missing test begin message\n"
+  if !grep (/^\(thread-churn\) begin$/, @output);
+fail "not every thread was created\n"
+  if !grep (/^\(thread-churn\) Created and exited 2000 threads\.$/, @output);
+fail "missing cost report\n"
+  if !grep (/^\(thread-churn\) \d+ cycles per thread, \d+ threads\/s\.$/, @output);
+fail "missing test end message\n"
+  if !grep (/^\(thread-churn\) end$/, @output);
+pass;
@@ -0,0 +1,47 @@
+/* Queues one work item on each work queue while the main thread
+   keeps the CPU, then checks that the workers run them in
+   priority order once it blocks. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+
+static struct semaphore done_sema;
+
+static void
+record_work (void *name_) 
+{
+  const char *name = name_;
+
+  msg ("Work \"%s\" ran in thread \"%s\".", name, thread_name ());
+  sema_up (&done_sema);
+}
+
+void
+test_workqueue (void) 
+{
+  struct work high, normal, low;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&done_sema, 0);
+  work_init (&high, record_work, "high");
+  work_init (&normal, record_work, "default");
+  work_init (&low, record_work, "low");
+
+  thread_set_priority (PRI_MAX);
+  ASSERT (work_queue (WORK_LOW, &low));
+  ASSERT (work_queue (WORK_DEFAULT, &normal));
+  ASSERT (work_queue (WORK_HIGH, &high));
+  if (!work_queue (WORK_LOW, &low))
+    msg ("Queueing pending work again does nothing.");
+  msg ("Waiting for the workers.");
+  for (i = 0; i < 3; i++)
+    sema_down (&done_sema);
+  thread_set_priority (PRI_DEFAULT);
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) Queueing pending work again does nothing.
+(workqueue) Waiting for the workers.
+(workqueue) Work "high" ran in thread "kworker-high".
+(workqueue) Work "default" ran in thread "kworker".
+(workqueue) Work "low" ran in thread "kworker-low".
+(workqueue) end
+EOF
+pass;
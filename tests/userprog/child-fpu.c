@@ -0,0 +1,16 @@
+/* Child process run by fpu-fresh.
+   Checks that a freshly executed program starts with zeroed XMM
+   registers and the default MXCSR. */
+
+#include "tests/lib.h"
+#include "tests/userprog/fpu.h"
+
+const char *test_name = "child-fpu";
+
+int
+main (void) 
+{
+  CHECK (xmm_all_zero (), "XMM registers are zero");
+  CHECK (mxcsr_get () == MXCSR_DEFAULT, "MXCSR is the default");
+  return 0;
+}
@@ -0,0 +1,17 @@
+/* Stores to a 16-byte aligned local variable with movaps, which
+   faults unless the stack was aligned as the x86-64 ABI requires
+   when the kernel entered _start. */
+
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  uint8_t buf[16] __attribute__ ((aligned (16)));
+
+  CHECK (((uintptr_t) buf & 15) == 0, "local variable is 16-byte aligned");
+  asm volatile ("xorps %%xmm0, %%xmm0\n\tmovaps %%xmm0, %0" : "=m" (buf));
+  msg ("movaps to the stack did not fault");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fpu-align) begin
+(fpu-align) local variable is 16-byte aligned
+(fpu-align) movaps to the stack did not fault
+(fpu-align) end
+fpu-align: exit(0)
+EOF
+pass;
@@ -0,0 +1,38 @@
+/* Checks that a new process starts with zeroed XMM registers: the
+   test itself, a forked child, which inherits only the parent's
+   MXCSR control bits, and a program that the child executes after
+   dirtying its own registers. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/fpu.h"
+
+/* Round toward zero. */
+#define MXCSR_RC_ZERO 0x6000
+
+void
+test_main (void) 
+{
+  uint8_t regs[XMM_CNT][16];
+  int pid;
+
+  CHECK (xmm_all_zero (), "XMM registers are zero at start");
+  CHECK (mxcsr_get () == MXCSR_DEFAULT, "MXCSR is the default at start");
+
+  xmm_fill (regs, 1);
+  xmm_load (regs);
+  mxcsr_set (MXCSR_DEFAULT | MXCSR_RC_ZERO);
+
+  if ((pid = fork ("child")) == 0) 
+    {
+      CHECK (xmm_all_zero (), "forked child's XMM registers are zero");
+      CHECK (mxcsr_get () == (MXCSR_DEFAULT | MXCSR_RC_ZERO),
+             "forked child inherits the rounding mode");
+      xmm_fill (regs, 2);
+      xmm_load (regs);
+      exec ("child-fpu");
+      fail ("exec failed");
+    }
+  CHECK (wait (pid) == 0, "wait for child");
+}
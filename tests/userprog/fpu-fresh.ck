@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fpu-fresh) begin
+(fpu-fresh) XMM registers are zero at start
+(fpu-fresh) MXCSR is the default at start
+(fpu-fresh) forked child's XMM registers are zero
+(fpu-fresh) forked child inherits the rounding mode
+(child-fpu) XMM registers are zero
+(child-fpu) MXCSR is the default
+child: exit(0)
+(fpu-fresh) wait for child
+(fpu-fresh) end
+fpu-fresh: exit(0)
+EOF
+pass;
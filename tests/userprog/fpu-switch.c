@@ -0,0 +1,58 @@
+/* Forks a child, then has both processes fill every XMM register
+   and the top of the x87 stack with their own values and spin for
+   a while, so that the timer switches between them several times.
+   Each checks on every iteration that its values survived. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/fpu.h"
+
+/* How long the child and the parent spin, in nanoseconds.  The
+   child stops well before the parent so that its exit message
+   comes first. */
+#define CHILD_SPIN_NS (200LL * 1000 * 1000)
+#define PARENT_SPIN_NS (600LL * 1000 * 1000)
+
+/* Loads SEED's pattern into the XMM registers and SEED onto the
+   x87 stack, and checks them until SPIN_NS have passed. */
+static void
+spin (const char *who, int seed, long long spin_ns) 
+{
+  uint8_t expected[XMM_CNT][16], actual[XMM_CNT][16];
+  long long start = clock_ns ();
+
+  xmm_fill (expected, seed);
+  xmm_load (expected);
+  asm volatile ("fildl %0" : : "m" (seed));
+
+  while (clock_ns () - start < spin_ns) 
+    {
+      int top;
+
+      xmm_store (actual);
+      if (memcmp (actual, expected, sizeof actual))
+        fail ("%s: XMM registers changed", who);
+      asm volatile ("fld %%st(0)\n\tfistpl %0" : "=m" (top));
+      if (top != seed)
+        fail ("%s: x87 stack top changed from %d to %d", who, seed, top);
+    }
+  asm volatile ("fstp %st(0)");
+}
+
+void
+test_main (void) 
+{
+  int pid;
+
+  if ((pid = fork ("child")) == 0) 
+    {
+      spin ("child", 2, CHILD_SPIN_NS);
+      exit (0);
+    }
+
+  spin ("parent", 1, PARENT_SPIN_NS);
+  msg ("parent: registers survived");
+  CHECK (wait (pid) == 0, "child: registers survived");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fpu-switch) begin
+child: exit(0)
+(fpu-switch) parent: registers survived
+(fpu-switch) child: registers survived
+(fpu-switch) end
+fpu-switch: exit(0)
+EOF
+pass;
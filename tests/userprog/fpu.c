@@ -0,0 +1,96 @@
+/* Utility functions for tests that check that the kernel keeps
+   each process's FPU and SSE registers apart.
+
+   These tests do no floating-point arithmetic, so the compiler
+   leaves the XMM registers alone: values loaded into them stay
+   there, across function calls and system calls, until the
+   program changes them again. */
+
+#include <string.h>
+#include "tests/userprog/fpu.h"
+
+/* Loads XMM0 through XMM15 from REGS. */
+void
+xmm_load (const uint8_t regs[XMM_CNT][16]) 
+{
+  asm volatile ("movdqu 0(%0), %%xmm0\n\t"
+                "movdqu 16(%0), %%xmm1\n\t"
+                "movdqu 32(%0), %%xmm2\n\t"
+                "movdqu 48(%0), %%xmm3\n\t"
+                "movdqu 64(%0), %%xmm4\n\t"
+                "movdqu 80(%0), %%xmm5\n\t"
+                "movdqu 96(%0), %%xmm6\n\t"
+                "movdqu 112(%0), %%xmm7\n\t"
+                "movdqu 128(%0), %%xmm8\n\t"
+                "movdqu 144(%0), %%xmm9\n\t"
+                "movdqu 160(%0), %%xmm10\n\t"
+                "movdqu 176(%0), %%xmm11\n\t"
+                "movdqu 192(%0), %%xmm12\n\t"
+                "movdqu 208(%0), %%xmm13\n\t"
+                "movdqu 224(%0), %%xmm14\n\t"
+                "movdqu 240(%0), %%xmm15"
+                : : "r" (regs) : "memory");
+}
+
+/* Stores XMM0 through XMM15 into REGS. */
+void
+xmm_store (uint8_t regs[XMM_CNT][16]) 
+{
+  asm volatile ("movdqu %%xmm0, 0(%0)\n\t"
+                "movdqu %%xmm1, 16(%0)\n\t"
+                "movdqu %%xmm2, 32(%0)\n\t"
+                "movdqu %%xmm3, 48(%0)\n\t"
+                "movdqu %%xmm4, 64(%0)\n\t"
+                "movdqu %%xmm5, 80(%0)\n\t"
+                "movdqu %%xmm6, 96(%0)\n\t"
+                "movdqu %%xmm7, 112(%0)\n\t"
+                "movdqu %%xmm8, 128(%0)\n\t"
+                "movdqu %%xmm9, 144(%0)\n\t"
+                "movdqu %%xmm10, 160(%0)\n\t"
+                "movdqu %%xmm11, 176(%0)\n\t"
+                "movdqu %%xmm12, 192(%0)\n\t"
+                "movdqu %%xmm13, 208(%0)\n\t"
+                "movdqu %%xmm14, 224(%0)\n\t"
+                "movdqu %%xmm15, 240(%0)"
+                : : "r" (regs) : "memory");
+}
+
+/* Fills REGS with a byte pattern that differs for each register
+   and each SEED. */
+void
+xmm_fill (uint8_t regs[XMM_CNT][16], int seed) 
+{
+  int i, j;
+
+  for (i = 0; i < XMM_CNT; i++)
+    for (j = 0; j < 16; j++)
+      regs[i][j] = seed * 31 + i * 16 + j + 1;
+}
+
+/* Returns true if every XMM register is zero. */
+bool
+xmm_all_zero (void) 
+{
+  static const uint8_t zero[XMM_CNT][16];
+  uint8_t regs[XMM_CNT][16];
+
+  xmm_store (regs);
+  return !memcmp (regs, zero, sizeof regs);
+}
+
+/* Returns the SSE control and status register. */
+uint32_t
+mxcsr_get (void) 
+{
+  uint32_t mxcsr;
+
+  asm volatile ("stmxcsr %0" : "=m" (mxcsr));
+  return mxcsr;
+}
+
+/* Sets the SSE control and status register to MXCSR. */
+void
+mxcsr_set (uint32_t mxcsr) 
+{
+  asm volatile ("ldmxcsr %0" : : "m" (mxcsr));
+}
@@ -0,0 +1,20 @@
+#ifndef TESTS_USERPROG_FPU_H
+#define TESTS_USERPROG_FPU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Number of XMM registers in 64-bit mode. */
+#define XMM_CNT 16
+
+/* Initial MXCSR: all SIMD exceptions masked, round to nearest. */
+#define MXCSR_DEFAULT 0x1f80
+
+void xmm_load (const uint8_t regs[XMM_CNT][16]);
+void xmm_store (uint8_t regs[XMM_CNT][16]);
+void xmm_fill (uint8_t regs[XMM_CNT][16], int seed);
+bool xmm_all_zero (void);
+uint32_t mxcsr_get (void);
+void mxcsr_set (uint32_t);
+
+#endif /* tests/userprog/fpu.h */
@@ -0,0 +1,35 @@
+/* Checks futex() calls that must not sleep, and that the user
+   mutex and condition variable work without contention. */
+
+#include <synch.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int word = 1;
+static struct mutex mutex;
+static struct condvar condvar;
+
+void
+test_main (void) 
+{
+  CHECK (futex (&word, FUTEX_WAIT, 0) == -1,
+         "wait on a changed value returns at once");
+  CHECK (futex (&word, FUTEX_WAKE, 1) == 0, "wake with no sleepers");
+  CHECK (futex ((int *) ((char *) &word + 1), FUTEX_WAKE, 1) == -1,
+         "misaligned address is rejected");
+  CHECK (futex (&word, 2, 0) == -1, "invalid operation is rejected");
+
+  mutex_init (&mutex);
+  mutex_lock (&mutex);
+  CHECK (!mutex_trylock (&mutex), "trylock fails while locked");
+  mutex_unlock (&mutex);
+  CHECK (mutex_trylock (&mutex), "trylock succeeds once unlocked");
+  mutex_unlock (&mutex);
+  CHECK (mutex.state == 0, "unlock leaves the mutex free");
+
+  condvar_init (&condvar);
+  condvar_signal (&condvar);
+  condvar_broadcast (&condvar);
+  msg ("signal and broadcast with no waiters");
+}
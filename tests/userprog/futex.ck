@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex) begin
+(futex) wait on a changed value returns at once
+(futex) wake with no sleepers
+(futex) misaligned address is rejected
+(futex) invalid operation is rejected
+(futex) trylock fails while locked
+(futex) trylock succeeds once unlocked
+(futex) unlock leaves the mutex free
+(futex) signal and broadcast with no waiters
+(futex) end
+futex: exit(0)
+EOF
+pass;
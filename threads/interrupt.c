@@ -6,6 +6,7 @@
 #include "threads/flags.h"
 #include "threads/intr-stubs.h"
 #include "threads/io.h"
+#include "threads/irqsoff.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "threads/vaddr.h"
@@ -103,6 +104,27 @@ static const char *intr_names[INTR_CNT];
 static bool in_external_intr;   /* Are we processing an external interrupt? */
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
+/* Softirqs.
+
+   An external interrupt handler should do only what cannot wait,
+   such as acknowledging its device, and leave the rest to a
+   softirq with intr_raise_softirq().  Raised softirqs run once
+   the interrupt has been acknowledged on the PIC, with interrupts
+   turned back on, so other devices are not kept waiting while
+   they run.  They still count as interrupt context: they may not
+   sleep, and a softirq is never pre-empted by a thread.  An
+   interrupt that arrives during a softirq runs its handler, but
+   leaves any softirqs it raises, and any yield it requests, to
+   the softirq run it interrupted. */
+#define SOFTIRQ_MAX_RESTART 10  /* Passes before leaving the rest. */
+
+static softirq_func *softirq_handlers[SOFTIRQ_CNT];
+static const char *softirq_names[SOFTIRQ_CNT];
+static unsigned softirq_pending;  /* Bit N set if softirq N is raised. */
+static bool in_softirq;           /* Are we running softirqs? */
+
+static void softirq_run (void);
+
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
 static void pic_end_of_interrupt (int irq);
@@ -135,7 +157,12 @@ intr_set_level (enum intr_level level) {
 enum intr_level
 intr_enable (void) {
 	enum intr_level old_level = intr_get_level ();
-	ASSERT (!intr_context ());
+	ASSERT (!in_external_intr);
+
+#ifdef IRQSOFF
+	if (old_level == INTR_OFF)
+		irqsoff_end (false);
+#endif
 
 	/* Enable interrupts by setting the interrupt flag.
 
@@ -156,6 +183,11 @@ intr_disable (void) {
 	   Hardware Interrupts". */
 	asm volatile ("cli" : : : "memory");
 
+#ifdef IRQSOFF
+	if (old_level == INTR_ON)
+		irqsoff_begin (false);
+#endif
+
 	return old_level;
 }
 
@@ -252,11 +284,38 @@ intr_register_int (uint8_t vec_no, int dpl, enum intr_level level,
 	register_handler (vec_no, dpl, level, handler, name);
 }
 
-/* Returns true during processing of an external interrupt
-   and false at all other times. */
+/* Registers softirq NR to invoke HANDLER, which is named NAME
+   for debugging purposes. */
+void
+intr_register_softirq (enum softirq nr, softirq_func *handler,
+		const char *name) {
+	ASSERT (nr < SOFTIRQ_CNT);
+	ASSERT (softirq_handlers[nr] == NULL);
+
+	softirq_handlers[nr] = handler;
+	softirq_names[nr] = name;
+}
+
+/* Marks softirq NR to run when the current external interrupt,
+   or the softirq run that it interrupted, finishes.  Softirqs
+   raised outside an interrupt run at the end of the next one. */
+void
+intr_raise_softirq (enum softirq nr) {
+	enum intr_level old_level;
+
+	ASSERT (nr < SOFTIRQ_CNT);
+	ASSERT (softirq_handlers[nr] != NULL);
+
+	old_level = intr_disable ();
+	softirq_pending |= 1u << nr;
+	intr_set_level (old_level);
+}
+
+/* Returns true during processing of an external interrupt or
+   its softirqs and false at all other times. */
 bool
 intr_context (void) {
-	return in_external_intr;
+	return in_external_intr || in_softirq;
 }
 
 /* During processing of an external interrupt, directs the
@@ -338,12 +397,18 @@ intr_handler (struct intr_frame *frame) {
 	   and they need to be acknowledged on the PIC (see below).
 	   An external interrupt handler cannot sleep. */
 	external = frame->vec_no >= 0x20 && frame->vec_no < 0x30;
+#ifdef IRQSOFF
+	/* The gate turned interrupts off if they were on. */
+	if (frame->eflags & FLAG_IF)
+		irqsoff_begin ((frame->cs & 3) == 3);
+#endif
 	if (external) {
 		ASSERT (intr_get_level () == INTR_OFF);
-		ASSERT (!intr_context ());
+		ASSERT (!in_external_intr);
 
 		in_external_intr = true;
-		yield_on_return = false;
+		if (!in_softirq)
+			yield_on_return = false;
 	}
 
 	/* Invoke the interrupt's handler. */
@@ -369,9 +434,46 @@ intr_handler (struct intr_frame *frame) {
 		in_external_intr = false;
 		pic_end_of_interrupt (frame->vec_no);
 
-		if (yield_on_return)
-			thread_yield ();
+		if (!in_softirq) {
+			softirq_run ();
+			if (yield_on_return)
+				thread_yield ();
+		}
+	}
+
+#ifdef IRQSOFF
+	/* iretq turns interrupts back on. */
+	if (frame->eflags & FLAG_IF)
+		irqsoff_end ((frame->cs & 3) == 3);
+#endif
+}
+
+/* Runs the raised softirqs with interrupts on, rerunning any
+   raised meanwhile up to SOFTIRQ_MAX_RESTART times.  What is
+   still raised after that waits for the next interrupt, so a
+   flood of interrupts cannot keep threads from running.  Called
+   with interrupts off at the end of an external interrupt, and
+   returns with them off. */
+static void
+softirq_run (void) {
+	int restart;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (!in_softirq);
+
+	in_softirq = true;
+	for (restart = 0; softirq_pending != 0 && restart < SOFTIRQ_MAX_RESTART;
+			restart++) {
+		unsigned pending = softirq_pending;
+
+		softirq_pending = 0;
+		intr_enable ();
+		for (int nr = 0; nr < SOFTIRQ_CNT; nr++)
+			if (pending & (1u << nr))
+				softirq_handlers[nr] ();
+		intr_disable ();
 	}
+	in_softirq = false;
 }
 
 /* Dumps interrupt frame F to the console, for debugging. */
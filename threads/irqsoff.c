@@ -0,0 +1,152 @@
+#include "threads/irqsoff.h"
+#include <debug.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+/* Interrupts-off latency tracer.
+
+   When the kernel is built with IRQSOFF defined, intr_disable()
+   calls irqsoff_begin() whenever it turns interrupts off, and
+   intr_enable() calls irqsoff_end() whenever it turns them back
+   on.  Interrupt and exception entry, which turn interrupts off
+   in hardware, do the same around their handlers.  Each section
+   is timed with the TSC, and the IRQSOFF_TOP longest, each with
+   the call stack that turned interrupts off and the call site
+   that turned them on again, are kept for irqsoff_print_stats()
+   to print at power off.
+
+   A section can end without a call to irqsoff_end(), for example
+   when iretq or sti restores the interrupt flag directly.  Such a
+   section stays open until the next real transition starts a new
+   one in its place, so it is never reported as long. */
+
+#define IRQSOFF_TOP 8           /* # of longest sections kept. */
+#define IRQSOFF_DEPTH 8         /* # of frames kept per call stack. */
+#define IRQSOFF_SITE 2          /* # of frames that identify a call site. */
+
+/* One interrupts-off section. */
+struct irqsoff_section {
+	uint64_t cycles;                  /* Length, in TSC cycles. */
+	void *off[IRQSOFF_DEPTH];         /* Call stack that turned them off. */
+	void *on[IRQSOFF_SITE];           /* Call site that turned them on. */
+};
+
+/* Section in progress. */
+static bool active;
+static uint64_t start;
+static void *start_stack[IRQSOFF_DEPTH];
+
+/* Longest sections so far, longest first. */
+static struct irqsoff_section top[IRQSOFF_TOP];
+static int64_t section_cnt;
+
+static void save_stack (void **frame, void **pcs, int cnt, bool user);
+
+/* Starts timing an interrupts-off section.  Called with
+   interrupts off, right after they were turned off.  USER is
+   true if intr_handler() calls us for an interrupt from user
+   mode, whose frame pointer must not be followed. */
+void
+irqsoff_begin (bool user) {
+	/* Skip our caller, intr_disable() or intr_handler(), and keep
+	   the call stack from its caller on. */
+	void **frame = __builtin_frame_address (0);
+
+	save_stack (frame[0], start_stack, IRQSOFF_DEPTH, user);
+	start = rdtsc ();
+	active = true;
+}
+
+/* Ends the section in progress, if any, and records it if it is
+   among the longest so far.  Called with interrupts off, right
+   before they are turned back on.  USER is as for
+   irqsoff_begin(). */
+void
+irqsoff_end (bool user) {
+	void **frame = __builtin_frame_address (0);
+	void *on[IRQSOFF_SITE];
+	uint64_t cycles;
+	int i;
+
+	if (!active)
+		return;
+	active = false;
+	cycles = rdtsc () - start;
+	section_cnt++;
+	save_stack (frame[0], on, IRQSOFF_SITE, user);
+
+	/* Keep only the longest section seen from each pair of call
+	   sites, so that one hot path does not fill the table.  A site
+	   is two frames deep because many sections begin or end in
+	   intr_set_level(). */
+	for (i = 0; i < IRQSOFF_TOP; i++)
+		if (top[i].cycles != 0
+				&& !memcmp (top[i].off, start_stack, sizeof top[i].on)
+				&& !memcmp (top[i].on, on, sizeof top[i].on))
+			break;
+	if (i == IRQSOFF_TOP)
+		i = IRQSOFF_TOP - 1;
+	if (cycles <= top[i].cycles)
+		return;
+
+	/* Move it up past every shorter section. */
+	for (; i > 0 && top[i - 1].cycles < cycles; i--)
+		top[i] = top[i - 1];
+	top[i].cycles = cycles;
+	memcpy (top[i].off, start_stack, sizeof top[i].off);
+	memcpy (top[i].on, on, sizeof top[i].on);
+}
+
+/* Prints the longest interrupts-off sections.  The addresses can
+   be translated with the `backtrace' program, as for
+   debug_backtrace(). */
+void
+irqsoff_print_stats (void) {
+	struct irqsoff_section copy[IRQSOFF_TOP];
+	enum intr_level old_level;
+	int64_t cnt;
+	int i, j;
+
+	/* printf() turns interrupts off itself, so take a snapshot. */
+	old_level = intr_disable ();
+	memcpy (copy, top, sizeof copy);
+	cnt = section_cnt;
+	intr_set_level (old_level);
+
+	printf ("Irqsoff: %lld sections, longest:\n", cnt);
+	for (i = 0; i < IRQSOFF_TOP && copy[i].cycles != 0; i++) {
+		printf ("  %llu cycles, off at", (unsigned long long) copy[i].cycles);
+		for (j = 0; j < IRQSOFF_DEPTH && copy[i].off[j] != NULL; j++)
+			printf (" %p", copy[i].off[j]);
+		printf (", on at");
+		for (j = 0; j < IRQSOFF_SITE && copy[i].on[j] != NULL; j++)
+			printf (" %p", copy[i].on[j]);
+		printf (".\n");
+	}
+}
+
+/* Stores the return addresses of up to CNT stack frames, starting
+   with FRAME, into PCS, and fills the rest with null pointers.
+   Stops at the first frame outside the running thread's stack
+   page.  If USER is true, FRAME is intr_handler()'s frame for an
+   interrupt from user mode, and the frame pointer it saved is a
+   user value, so only FRAME itself is recorded. */
+static void
+save_stack (void **frame, void **pcs, int cnt, bool user) {
+	void *stack = pg_round_down (__builtin_frame_address (0));
+	int i;
+
+	if (user && cnt > 1)
+		cnt = 1;
+	for (i = 0; i < cnt && pg_round_down (frame) == stack && frame[0] != NULL; i++) {
+		pcs[i] = frame[1];
+		frame = frame[0];
+	}
+	for (; i < cnt; i++)
+		pcs[i] = NULL;
+}
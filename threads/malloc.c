@@ -11,35 +11,62 @@
 
 /* A simple implementation of malloc().
 
-   The size of each request, in bytes, is rounded up to a power
-   of 2 and assigned to the "descriptor" that manages blocks of
-   that size.  The descriptor keeps a list of free blocks.  If
-   the free list is nonempty, one of its blocks is used to
-   satisfy the request.
-
-   Otherwise, a new page of memory, called an "arena", is
-   obtained from the page allocator (if none is available,
-   malloc() returns a null pointer).  The new arena is divided
-   into blocks, all of which are added to the descriptor's free
-   list.  Then we return one of the new blocks.
+   The size of each request, in bytes, is rounded up to a size
+   class and assigned to the "descriptor" that manages blocks of
+   that size.  The classes are the powers of 2 up to 256 bytes,
+   then four classes per doubling, each a quarter of the power of
+   2 below it larger than the last (320, 384, 448, 512, 640, ...),
+   up to MAX_BLOCK_SIZE.  The descriptor keeps a list of free
+   blocks.  If the free list is nonempty, one of its blocks is
+   used to satisfy the request.
+
+   Otherwise, a new run of pages, called an "arena", is obtained
+   from the page allocator (if none is available, malloc()
+   returns a null pointer).  The new arena is divided into
+   blocks, all of which are added to the descriptor's free list.
+   Then we return one of the new blocks.  Each descriptor's
+   arenas are as few pages as leave no more than an eighth of
+   the arena unused, so small classes use one-page arenas and
+   larger ones use several pages.
 
    When we free a block, we add it to its descriptor's free list.
    But if the arena that the block was in now has no in-use
    blocks, we remove all of the arena's blocks from the free list
    and give the arena back to the page allocator.
 
-   We can't handle blocks bigger than 2 kB using this scheme,
-   because they're too big to fit in a single page with a
-   descriptor.  We handle those by allocating contiguous pages
-   with the page allocator and sticking the allocation size at
-   the beginning of the allocated block's arena header. */
+   A block in a one-page arena finds its arena header by rounding
+   down to the page boundary.  A block in a multi-page arena may
+   lie in a later page, whose start holds some other block's
+   contents, so each page of such an arena records the arena as
+   its owner with palloc_set_owner() instead.  Blocks themselves
+   carry no header.
+
+   We can't handle blocks bigger than MAX_BLOCK_SIZE using this
+   scheme.  We handle those by allocating contiguous pages with
+   the page allocator and sticking the allocation size at the
+   beginning of the allocated block's arena header.
+
+   realloc() keeps a block in place while the new size still
+   falls in the block's size class.  A big block shrinks in place
+   by giving back its tail pages, and grows in place if the pages
+   right after it are free.  Other blocks move. */
+
+/* Largest size class, in bytes. */
+#define MAX_BLOCK_SIZE (64 * 1024)
 
 /* Descriptor. */
 struct desc {
 	size_t block_size;          /* Size of each element in bytes. */
+	size_t arena_pages;         /* Number of pages in an arena. */
 	size_t blocks_per_arena;    /* Number of blocks in an arena. */
 	struct list free_list;      /* List of free blocks. */
 	struct lock lock;           /* Lock. */
+
+	/* Statistics. */
+	size_t arena_cnt;           /* Arenas allocated. */
+	size_t in_use;              /* Blocks allocated. */
+	long long alloc_cnt;        /* Blocks ever allocated. */
+	long long requested;        /* Bytes ever requested. */
 };
 
 /* Magic number for detecting arena corruption. */
@@ -58,24 +85,47 @@ struct block {
 };
 
 /* Our set of descriptors. */
-static struct desc descs[10];   /* Descriptors. */
+static struct desc descs[40];   /* Descriptors. */
 static size_t desc_cnt;         /* Number of descriptors. */
 
+static struct desc *size_to_desc (size_t size);
 static struct arena *block_to_arena (struct block *);
 static struct block *arena_to_block (struct arena *, size_t idx);
 
 /* Initializes the malloc() descriptors. */
 void
 malloc_init (void) {
-	size_t block_size;
+	size_t block_size, step;
 
-	for (block_size = 16; block_size < PGSIZE / 2; block_size *= 2) {
+	for (block_size = 16; block_size <= MAX_BLOCK_SIZE; block_size += step) {
 		struct desc *d = &descs[desc_cnt++];
+		size_t pages, space;
+
 		ASSERT (desc_cnt <= sizeof descs / sizeof *descs);
 		d->block_size = block_size;
-		d->blocks_per_arena = (PGSIZE - sizeof (struct arena)) / block_size;
+
+		/* Find the smallest arena that wastes at most an eighth of
+		   its pages. */
+		for (pages = 1; ; pages++) {
+			space = pages * PGSIZE - sizeof (struct arena);
+			d->blocks_per_arena = space / block_size;
+			if (d->blocks_per_arena > 0
+					&& space - d->blocks_per_arena * block_size <= pages * PGSIZE / 8)
+				break;
+		}
+		d->arena_pages = pages;
+
 		list_init (&d->free_list);
 		lock_init (&d->lock);
+		d->arena_cnt = d->in_use = 0;
+		d->alloc_cnt = d->requested = 0;
+
+		/* Double up to 256 bytes, then take steps of a quarter of
+		   the power of 2 at or below BLOCK_SIZE. */
+		for (step = block_size; step & (step - 1); step &= step - 1)
+			continue;
+		if (block_size >= 256)
+			step /= 4;
 	}
 }
 
@@ -93,10 +143,8 @@ malloc (size_t size) {
 
 	/* Find the smallest descriptor that satisfies a SIZE-byte
 	   request. */
-	for (d = descs; d < descs + desc_cnt; d++)
-		if (d->block_size >= size)
-			break;
-	if (d == descs + desc_cnt) {
+	d = size_to_desc (size);
+	if (d == NULL) {
 		/* SIZE is too big for any descriptor.
 		   Allocate enough pages to hold SIZE plus an arena. */
 		size_t page_cnt = DIV_ROUND_UP (size + sizeof *a, PGSIZE);
@@ -118,8 +166,8 @@ malloc (size_t size) {
 	if (list_empty (&d->free_list)) {
 		size_t i;
 
-		/* Allocate a page. */
-		a = palloc_get_page (0);
+		/* Allocate the arena's pages. */
+		a = palloc_get_multiple (0, d->arena_pages);
 		if (a == NULL) {
 			lock_release (&d->lock);
 			return NULL;
@@ -129,16 +177,22 @@ malloc (size_t size) {
 		a->magic = ARENA_MAGIC;
 		a->desc = d;
 		a->free_cnt = d->blocks_per_arena;
+		if (d->arena_pages > 1)
+			palloc_set_owner (a, d->arena_pages, a);
 		for (i = 0; i < d->blocks_per_arena; i++) {
 			struct block *b = arena_to_block (a, i);
 			list_push_back (&d->free_list, &b->free_elem);
 		}
+		d->arena_cnt++;
 	}
 
 	/* Get a block from free list and return it. */
 	b = list_entry (list_pop_front (&d->free_list), struct block, free_elem);
 	a = block_to_arena (b);
 	a->free_cnt--;
+	d->in_use++;
+	d->alloc_cnt++;
+	d->requested += size;
 	lock_release (&d->lock);
 	return b;
 }
@@ -178,16 +232,41 @@ block_size (void *block) {
    If successful, returns the new block; on failure, returns a
    null pointer.
    A call with null OLD_BLOCK is equivalent to malloc(NEW_SIZE).
-   A call with zero NEW_SIZE is equivalent to free(OLD_BLOCK). */
+   A call with zero NEW_SIZE is equivalent to free(OLD_BLOCK).
+   A block whose size class NEW_SIZE still falls in is resized in
+   place.  A big block that stays big gives back the pages it no
+   longer needs, or takes the free pages after it if it grows. */
 void *
 realloc (void *old_block, size_t new_size) {
 	if (new_size == 0) {
 		free (old_block);
 		return NULL;
-	} else {
-		void *new_block = malloc (new_size);
-		if (old_block != NULL && new_block != NULL) {
-			size_t old_size = block_size (old_block);
+	} else if (old_block == NULL)
+		return malloc (new_size);
+	else {
+		size_t old_size = block_size (old_block);
+		struct arena *a = block_to_arena (old_block);
+		void *new_block;
+
+		if (a->desc != NULL) {
+			if (size_to_desc (new_size) == a->desc)
+				return old_block;
+		} else if (new_size > MAX_BLOCK_SIZE) {
+			size_t page_cnt = DIV_ROUND_UP (new_size + sizeof *a, PGSIZE);
+
+			if (page_cnt <= a->free_cnt) {
+				palloc_free_multiple ((uint8_t *) a + page_cnt * PGSIZE,
+						a->free_cnt - page_cnt);
+				a->free_cnt = page_cnt;
+				return old_block;
+			} else if (palloc_extend_multiple (a, a->free_cnt, page_cnt)) {
+				a->free_cnt = page_cnt;
+				return old_block;
+			}
+		}
+
+		new_block = malloc (new_size);
+		if (new_block != NULL) {
 			size_t min_size = new_size < old_size ? new_size : old_size;
 			memcpy (new_block, old_block, min_size);
 			free (old_block);
@@ -218,6 +297,8 @@ free (void *p) {
 			/* Add block to free list. */
 			list_push_front (&d->free_list, &b->free_elem);
 
+			d->in_use--;
+
 			/* If the arena is now entirely unused, free it. */
 			if (++a->free_cnt >= d->blocks_per_arena) {
 				size_t i;
@@ -227,7 +308,10 @@ free (void *p) {
 					struct block *b = arena_to_block (a, i);
 					list_remove (&b->free_elem);
 				}
-				palloc_free_page (a);
+				if (d->arena_pages > 1)
+					palloc_set_owner (a, d->arena_pages, NULL);
+				palloc_free_multiple (a, d->arena_pages);
+				d->arena_cnt--;
 			}
 
 			lock_release (&d->lock);
@@ -239,10 +323,58 @@ free (void *p) {
 	}
 }
 
+/* Prints the utilization of each size class that has been used:
+   the share of its arenas' bytes in allocated blocks, and the
+   share of the bytes handed out that callers asked for. */
+void
+malloc_print_stats (void) {
+	struct desc *d;
+
+	for (d = descs; d < descs + desc_cnt; d++) {
+		size_t arena_bytes, used_bytes;
+		long long granted;
+
+		if (d->alloc_cnt == 0)
+			continue;
+		arena_bytes = d->arena_cnt * d->arena_pages * PGSIZE;
+		used_bytes = d->in_use * d->block_size;
+		granted = d->alloc_cnt * (long long) d->block_size;
+		printf ("Malloc: %zu-byte blocks: %zu of %zu in use in %zu %zu-page "
+				"arenas (%zu%% used), %lld allocations (%lld%% requested)\n",
+				d->block_size, d->in_use, d->arena_cnt * d->blocks_per_arena,
+				d->arena_cnt, d->arena_pages,
+				arena_bytes > 0 ? used_bytes * 100 / arena_bytes : 0,
+				d->alloc_cnt, d->requested * 100 / granted);
+	}
+}
+
+/* Returns the smallest descriptor whose blocks hold SIZE bytes,
+   or a null pointer if SIZE is too big for any descriptor. */
+static struct desc *
+size_to_desc (size_t size) {
+	size_t lo = 0, hi = desc_cnt;
+
+	/* Binary search for the first block size >= SIZE. */
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		if (descs[mid].block_size < size)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo < desc_cnt ? &descs[lo] : NULL;
+}
+
 /* Returns the arena that block B is inside. */
 static struct arena *
 block_to_arena (struct block *b) {
-	struct arena *a = pg_round_down (b);
+	struct arena *a = palloc_get_owner (b);
+
+	/* Only the pages of multi-page arenas have an owner.  A block
+	   in a one-page arena, or a big block, lies in its arena's
+	   first page. */
+	if (a == NULL)
+		a = pg_round_down (b);
 
 	/* Check that the arena is valid. */
 	ASSERT (a != NULL);
@@ -250,7 +382,8 @@ block_to_arena (struct block *b) {
 
 	/* Check that the block is properly aligned for the arena. */
 	ASSERT (a->desc == NULL
-			|| (pg_ofs (b) - sizeof *a) % a->desc->block_size == 0);
+			|| ((uint8_t *) b - (uint8_t *) arena_to_block (a, 0))
+				% a->desc->block_size == 0);
 	ASSERT (a->desc != NULL || pg_ofs (b) == sizeof *a);
 
 	return a;
@@ -2,15 +2,18 @@
 #include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
-#include "threads/synch.h"
+#include "threads/thread.h"
 #include "threads/vaddr.h"
+#include "threads/workqueue.h"
 
 /* Page allocator.  Hands out memory in page-size (or
    page-multiple) chunks.  See malloc.h for an allocator that
@@ -24,13 +27,70 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Each pool is a binary buddy allocator.  Its free pages are kept
+   as blocks of 2**ORDER pages, each aligned to its own size
+   relative to the pool base, on one free list per order.  An
+   allocation takes a block of the smallest order that fits,
+   splitting a larger one if it must, and gives back the pages
+   past the request.  A freed block merges with its buddy, the
+   other half of the block twice its size, for as long as the
+   buddy is free too.  Both take O(log n) time, so the pools are
+   protected by turning interrupts off rather than by a lock.
+
+   The free lists are linked through an array of list elements,
+   one per page, instead of through the free pages themselves,
+   because not all of memory is mapped yet when the pools are
+   populated.
+
+   Each pool also keeps a few pages that are already zeroed, for
+   PAL_ZERO requests of one page to take without a memset.  A
+   work item on the WORK_LOW queue refills them, so the zeroing
+   happens when no other thread wants the CPU.  Pooled pages are
+   allocated as far as the buddy allocator is concerned; they are
+   linked through the same LINKS array as the free blocks, so
+   the pages themselves are never written.
+
+   Callers that need many pages at once, not necessarily
+   contiguous, use palloc_get_batch() and palloc_free_batch(),
+   which take the pool once for the whole batch.  Single user
+   pages go through a small magazine in the running thread
+   instead: a free lands in the magazine, an allocation takes
+   from it, and only when it is empty or full does half a
+   magazine's worth move to or from the pool as a batch.  A
+   thread's magazine is flushed when it exits.  Pages in a
+   magazine stay marked used, so ORDERS marks them IN_MAGAZINE to
+   catch a second free. */
+
+/* Largest block is 2**(ORDER_CNT - 1) pages. */
+#define ORDER_CNT 20
+
+/* Entry in a pool's ORDERS for a page that does not start a free
+   block. */
+#define NOT_FREE UINT8_MAX
+
+/* Entry in a pool's ORDERS for a user page that sits in some
+   thread's magazine.  Such a page is still marked used, so this
+   is what catches a second free of it. */
+#define IN_MAGAZINE (UINT8_MAX - 1)
+
+/* Most pre-zeroed pages kept in each pool, and the count below
+   which an allocation schedules a refill. */
+#define ZEROED_MAX 64
+#define ZEROED_LOW (ZEROED_MAX / 2)
 
 /* A memory pool. */
 struct pool {
-	struct lock lock;               /* Mutual exclusion. */
-	struct bitmap *used_map;        /* Bitmap of free pages. */
+	struct bitmap *used_map;        /* Bitmap of used pages. */
 	uint8_t *base;                  /* Base of pool. */
+	uint8_t *orders;                /* Order of the free block at each page. */
+	struct list_elem *links;        /* Free list element of each page. */
+	void **owners;                  /* Owner of each page, see palloc_set_owner(). */
+	struct list free_lists[ORDER_CNT];  /* Free blocks of each order. */
+	size_t free_cnt[ORDER_CNT];     /* # of blocks in each free list. */
+	struct list zeroed;             /* Pre-zeroed pages. */
+	size_t zeroed_cnt;              /* # of pages in ZEROED. */
 };
 
 /* Two pools: one for kernel data, one for user pages. */
@@ -38,10 +98,30 @@ static struct pool kernel_pool, user_pool;
 
 /* Maximum number of pages to put in user pool. */
 size_t user_page_limit = SIZE_MAX;
+
+/* Refills the pools' pre-zeroed pages.  Nothing schedules it
+   until palloc_zero_init() is called. */
+static struct work zero_work;
+static bool zeroing;
+
+/* PAL_ZERO requests served from, and not from, the zeroed pages. */
+static long long zero_hits, zero_misses;
+
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
 static bool page_from_pool (const struct pool *, void *page);
+static size_t buddy_alloc (struct pool *, int order);
+static void buddy_free (struct pool *, size_t page_idx, int order);
+static void free_range (struct pool *, size_t page_idx, size_t page_cnt);
+static size_t take_pages (struct pool *, size_t page_cnt);
+static bool take_range (struct pool *, size_t page_idx, size_t page_cnt);
+static size_t take_batch (struct pool *, void **pages, size_t page_cnt);
+static void release_batch (void **pages, size_t page_cnt);
+static void magazine_release (void **pages, size_t page_cnt);
+static struct pool *pool_of (void *page);
+static void drain_zeroed (struct pool *);
+static work_func zero_fill;
 
 /* multiboot info */
 struct multiboot_info {
@@ -224,11 +304,13 @@ split:
 			if ((uint64_t) pool_end < end) {
 				page_cnt = ((uint64_t) pool_end - start) / PGSIZE;
 				bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+				free_range (pool, page_idx, page_cnt);
 				start = (uint64_t) pool_end;
 				goto split;
 			} else {
 				page_cnt = ((uint64_t) end - start) / PGSIZE;
 				bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+				free_range (pool, page_idx, page_cnt);
 			}
 		}
 	}
@@ -253,6 +335,15 @@ palloc_init (void) {
 	return ext_mem.end;
 }
 
+/* Starts keeping pre-zeroed pages for PAL_ZERO.  Work queues
+   must be running. */
+void
+palloc_zero_init (void) {
+	work_init (&zero_work, zero_fill, NULL);
+	zeroing = true;
+	work_queue (WORK_LOW, &zero_work);
+}
+
 /* Obtains and returns a group of PAGE_CNT contiguous free pages.
    If PAL_USER is set, the pages are obtained from the user pool,
    otherwise from the kernel pool.  If PAL_ZERO is set in FLAGS,
@@ -262,19 +353,58 @@ palloc_init (void) {
 void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
-
-	lock_acquire (&pool->lock);
-	size_t page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-	lock_release (&pool->lock);
+	size_t page_idx = BITMAP_ERROR;
+	bool zeroed = false, refill = false;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if ((flags & PAL_ZERO) && page_cnt == 1 && pool->zeroed_cnt > 0) {
+		page_idx = list_pop_front (&pool->zeroed) - pool->links;
+		pool->zeroed_cnt--;
+		zeroed = true;
+	} else if (pool == &user_pool && page_cnt == 1) {
+		struct palloc_magazine *mag = &thread_current ()->magazine;
+
+		if (mag->cnt == 0) {
+			mag->cnt = take_batch (pool, mag->pages, PALLOC_MAGAZINE_SIZE / 2);
+			if (mag->cnt == 0 && pool->zeroed_cnt > 0) {
+				drain_zeroed (pool);
+				mag->cnt = take_batch (pool, mag->pages, PALLOC_MAGAZINE_SIZE / 2);
+			}
+		}
+		if (mag->cnt > 0) {
+			page_idx = pg_no (mag->pages[--mag->cnt]) - pg_no (pool->base);
+			pool->orders[page_idx] = NOT_FREE;
+		}
+	} else {
+		page_idx = take_pages (pool, page_cnt);
+		if (page_idx == BITMAP_ERROR && pool->zeroed_cnt > 0) {
+			/* Memory is short: the zeroed pages are worth more
+			   as free ones. */
+			drain_zeroed (pool);
+			page_idx = take_pages (pool, page_cnt);
+		}
+	}
+	if (flags & PAL_ZERO) {
+		if (zeroed)
+			zero_hits++;
+		else
+			zero_misses++;
+		refill = zeroing && pool->zeroed_cnt < ZEROED_LOW;
+	}
+	intr_set_level (old_level);
 	void *pages;
 
+	if (refill)
+		work_queue (WORK_LOW, &zero_work);
+
 	if (page_idx != BITMAP_ERROR)
 		pages = pool->base + PGSIZE * page_idx;
 	else
 		pages = NULL;
 
 	if (pages) {
-		if (flags & PAL_ZERO)
+		if ((flags & PAL_ZERO) && !zeroed)
 			memset (pages, 0, PGSIZE * page_cnt);
 	} else {
 		if (flags & PAL_ASSERT)
@@ -301,25 +431,39 @@ void
 palloc_free_multiple (void *pages, size_t page_cnt) {
 	struct pool *pool;
 	size_t page_idx;
+	enum intr_level old_level;
 
 	ASSERT (pg_ofs (pages) == 0);
 	if (pages == NULL || page_cnt == 0)
 		return;
 
-	if (page_from_pool (&kernel_pool, pages))
-		pool = &kernel_pool;
-	else if (page_from_pool (&user_pool, pages))
-		pool = &user_pool;
-	else
-		NOT_REACHED ();
-
+	pool = pool_of (pages);
 	page_idx = pg_no (pages) - pg_no (pool->base);
 
 #ifndef NDEBUG
 	memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
+	old_level = intr_disable ();
 	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
-	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+	if (pool == &user_pool && page_cnt == 1) {
+		struct palloc_magazine *mag = &thread_current ()->magazine;
+
+		ASSERT (pool->orders[page_idx] != IN_MAGAZINE);
+		if (mag->cnt == PALLOC_MAGAZINE_SIZE) {
+			mag->cnt -= PALLOC_MAGAZINE_SIZE / 2;
+			magazine_release (mag->pages + mag->cnt, PALLOC_MAGAZINE_SIZE / 2);
+		}
+		pool->orders[page_idx] = IN_MAGAZINE;
+		mag->pages[mag->cnt++] = pages;
+	} else {
+		for (size_t i = 0; i < page_cnt; i++) {
+			ASSERT (pool->orders[page_idx + i] != IN_MAGAZINE);
+			ASSERT (pool->owners[page_idx + i] == NULL);
+		}
+		bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+		free_range (pool, page_idx, page_cnt);
+	}
+	intr_set_level (old_level);
 }
 
 /* Frees the page at PAGE. */
@@ -328,25 +472,454 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
+/* Tries to grow the PAGE_CNT pages starting at PAGES, obtained
+   from palloc_get_multiple(), to NEW_CNT pages without moving
+   them.  Returns true if successful, false if any of the pages
+   that follow is not free. */
+bool
+palloc_extend_multiple (void *pages, size_t page_cnt, size_t new_cnt) {
+	struct pool *pool;
+	size_t page_idx;
+	enum intr_level old_level;
+	bool success;
+
+	ASSERT (pg_ofs (pages) == 0);
+	ASSERT (page_cnt > 0);
+	if (new_cnt <= page_cnt)
+		return true;
+
+	pool = pool_of (pages);
+	page_idx = pg_no (pages) - pg_no (pool->base) + page_cnt;
+	if (page_idx + (new_cnt - page_cnt) > bitmap_size (pool->used_map))
+		return false;
+
+	old_level = intr_disable ();
+	success = take_range (pool, page_idx, new_cnt - page_cnt);
+	intr_set_level (old_level);
+	return success;
+}
+
+/* Records OWNER, which may be null, as the owner of the PAGE_CNT
+   pages starting at PAGES, which the caller allocated.  Lets the
+   caller map an address anywhere in a run of pages back to the
+   object that manages the run.  The caller must reset the owner
+   to null before it frees the pages. */
+void
+palloc_set_owner (void *pages, size_t page_cnt, void *owner) {
+	struct pool *pool = pool_of (pages);
+	size_t page_idx = pg_no (pages) - pg_no (pool->base);
+
+	ASSERT (pg_ofs (pages) == 0);
+	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
+
+	for (size_t i = 0; i < page_cnt; i++)
+		pool->owners[page_idx + i] = owner;
+}
+
+/* Returns the owner recorded by palloc_set_owner() for the page
+   that contains ADDR, or a null pointer if there is none. */
+void *
+palloc_get_owner (const void *addr) {
+	struct pool *pool = pool_of ((void *) addr);
+
+	return pool->owners[pg_no (addr) - pg_no (pool->base)];
+}
+
+/* Obtains up to PAGE_CNT pages, not necessarily contiguous,
+   stores their kernel virtual addresses in PAGES, and returns
+   how many it obtained.  FLAGS are as for palloc_get_page().
+   With PAL_ASSERT, panics unless all PAGE_CNT pages were
+   available. */
+size_t
+palloc_get_batch (enum palloc_flags flags, void **pages, size_t page_cnt) {
+	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+	size_t zeroed_cnt = 0, cnt;
+	bool refill = false;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if (flags & PAL_ZERO)
+		while (zeroed_cnt < page_cnt && pool->zeroed_cnt > 0) {
+			pages[zeroed_cnt++] = pool->base
+				+ PGSIZE * (list_pop_front (&pool->zeroed) - pool->links);
+			pool->zeroed_cnt--;
+		}
+	cnt = zeroed_cnt + take_batch (pool, pages + zeroed_cnt, page_cnt - zeroed_cnt);
+	if (cnt < page_cnt && pool->zeroed_cnt > 0) {
+		drain_zeroed (pool);
+		cnt += take_batch (pool, pages + cnt, page_cnt - cnt);
+	}
+	if (flags & PAL_ZERO) {
+		zero_hits += zeroed_cnt;
+		zero_misses += cnt - zeroed_cnt;
+		refill = zeroing && pool->zeroed_cnt < ZEROED_LOW;
+	}
+	intr_set_level (old_level);
+
+	if (refill)
+		work_queue (WORK_LOW, &zero_work);
+	if (flags & PAL_ZERO)
+		for (size_t i = zeroed_cnt; i < cnt; i++)
+			memset (pages[i], 0, PGSIZE);
+	if (cnt < page_cnt && (flags & PAL_ASSERT))
+		PANIC ("palloc_get_batch: out of pages");
+	return cnt;
+}
+
+/* Frees the PAGE_CNT pages whose addresses are in PAGES, which
+   may come from either pool. */
+void
+palloc_free_batch (void **pages, size_t page_cnt) {
+	enum intr_level old_level;
+
+#ifndef NDEBUG
+	for (size_t i = 0; i < page_cnt; i++)
+		memset (pages[i], 0xcc, PGSIZE);
+#endif
+	old_level = intr_disable ();
+	release_batch (pages, page_cnt);
+	intr_set_level (old_level);
+}
+
+/* Returns the pages in the running thread's magazine to the user
+   pool. */
+void
+palloc_flush_magazine (void) {
+	struct palloc_magazine *mag = &thread_current ()->magazine;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	magazine_release (mag->pages, mag->cnt);
+	mag->cnt = 0;
+	intr_set_level (old_level);
+}
+
+/* Prints the free blocks of each order in POOL, named NAME. */
+static void
+print_pool_stats (const struct pool *pool, const char *name) {
+	size_t free_cnt[ORDER_CNT];
+	size_t page_cnt = 0;
+	enum intr_level old_level;
+	int order, top = 0;
+
+	old_level = intr_disable ();
+	memcpy (free_cnt, pool->free_cnt, sizeof free_cnt);
+	intr_set_level (old_level);
+
+	for (order = 0; order < ORDER_CNT; order++) {
+		page_cnt += free_cnt[order] << order;
+		if (free_cnt[order] != 0)
+			top = order;
+	}
+	printf ("Palloc: %s pool: %zu free pages, free blocks by order:",
+			name, page_cnt);
+	for (order = 0; order <= top; order++)
+		printf (" %zu", free_cnt[order]);
+	printf ("\n");
+}
+
+/* Prints page allocator statistics. */
+void
+palloc_print_stats (void) {
+	print_pool_stats (&kernel_pool, "kernel");
+	print_pool_stats (&user_pool, "user");
+	printf ("Palloc: zeroed pages: %lld hits, %lld misses, "
+			"%zu kernel and %zu user pages ready\n",
+			zero_hits, zero_misses, kernel_pool.zeroed_cnt, user_pool.zeroed_cnt);
+}
+
 /* Initializes pool P as starting at START and ending at END */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
-     and subtract it from the pool's size. */
+  /* We'll put the pool's used_map, links, owners and orders at
+     BM_BASE.  Calculate the space needed for them and advance
+     BM_BASE past it. */
 	uint64_t pgcnt = (end - start) / PGSIZE;
-	size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (pgcnt), PGSIZE) * PGSIZE;
-
-	lock_init(&p->lock);
-	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_pages);
+	size_t bm_size = ROUND_UP (bitmap_buf_size (pgcnt), sizeof *p->links);
+	size_t links_size = pgcnt * sizeof *p->links;
+	size_t owners_size = pgcnt * sizeof *p->owners;
+	size_t bm_pages = DIV_ROUND_UP (bm_size + links_size + owners_size + pgcnt,
+			PGSIZE) * PGSIZE;
+	int order;
+
+	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_size);
+	p->links = (struct list_elem *) ((uint8_t *) *bm_base + bm_size);
+	p->owners = (void **) ((uint8_t *) *bm_base + bm_size + links_size);
+	p->orders = (uint8_t *) *bm_base + bm_size + links_size + owners_size;
 	p->base = (void *) start;
+	for (order = 0; order < ORDER_CNT; order++) {
+		list_init (&p->free_lists[order]);
+		p->free_cnt[order] = 0;
+	}
+	list_init (&p->zeroed);
+	p->zeroed_cnt = 0;
 
 	// Mark all to unusable.
 	bitmap_set_all(p->used_map, true);
+	memset (p->orders, NOT_FREE, pgcnt);
+	memset (p->owners, 0, owners_size);
 
 	*bm_base += bm_pages;
 }
 
+/* Adds the free block of 2**ORDER pages at PAGE_IDX to P's free
+   lists. */
+static void
+block_insert (struct pool *p, size_t page_idx, int order) {
+	p->orders[page_idx] = order;
+	list_push_front (&p->free_lists[order], &p->links[page_idx]);
+	p->free_cnt[order]++;
+}
+
+/* Removes the free block of 2**ORDER pages at PAGE_IDX from P's
+   free lists. */
+static void
+block_remove (struct pool *p, size_t page_idx, int order) {
+	ASSERT (p->orders[page_idx] == order);
+
+	p->orders[page_idx] = NOT_FREE;
+	list_remove (&p->links[page_idx]);
+	p->free_cnt[order]--;
+}
+
+/* Takes a block of 2**ORDER pages from P and returns the index of
+   its first page, or BITMAP_ERROR if no block is large enough.
+   A larger block is split, and the halves not used go back to
+   the free lists. */
+static size_t
+buddy_alloc (struct pool *p, int order) {
+	size_t page_idx;
+	int o;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (o = order; o < ORDER_CNT && list_empty (&p->free_lists[o]); o++)
+		continue;
+	if (o == ORDER_CNT)
+		return BITMAP_ERROR;
+
+	page_idx = list_front (&p->free_lists[o]) - p->links;
+	block_remove (p, page_idx, o);
+	while (o > order) {
+		o--;
+		block_insert (p, page_idx + ((size_t) 1 << o), o);
+	}
+	return page_idx;
+}
+
+/* Returns the block of 2**ORDER pages at PAGE_IDX to P, merging
+   it with its buddy for as long as the buddy is free. */
+static void
+buddy_free (struct pool *p, size_t page_idx, int order) {
+	size_t pgcnt = bitmap_size (p->used_map);
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (page_idx % ((size_t) 1 << order) == 0);
+
+	for (; order < ORDER_CNT - 1; order++) {
+		size_t buddy = page_idx ^ ((size_t) 1 << order);
+
+		if (buddy >= pgcnt || p->orders[buddy] != order)
+			break;
+		block_remove (p, buddy, order);
+		page_idx &= ~((size_t) 1 << order);
+	}
+	block_insert (p, page_idx, order);
+}
+
+/* Returns the PAGE_CNT pages starting at PAGE_IDX to P, as the
+   largest aligned blocks that cover them. */
+static void
+free_range (struct pool *p, size_t page_idx, size_t page_cnt) {
+	while (page_cnt > 0) {
+		int order = 0;
+
+		while (order < ORDER_CNT - 1
+				&& page_idx % ((size_t) 2 << order) == 0
+				&& ((size_t) 2 << order) <= page_cnt)
+			order++;
+		buddy_free (p, page_idx, order);
+		page_idx += (size_t) 1 << order;
+		page_cnt -= (size_t) 1 << order;
+	}
+}
+
+/* Allocates PAGE_CNT contiguous pages from P's free blocks and
+   returns the index of the first, or BITMAP_ERROR if no block is
+   large enough.  Interrupts must be off. */
+static size_t
+take_pages (struct pool *p, size_t page_cnt) {
+	size_t page_idx;
+	int order = 0;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while (order < ORDER_CNT && ((size_t) 1 << order) < page_cnt)
+		order++;
+	if (page_cnt == 0 || order == ORDER_CNT)
+		return BITMAP_ERROR;
+
+	page_idx = buddy_alloc (p, order);
+	if (page_idx != BITMAP_ERROR) {
+		/* Give back the pages past PAGE_CNT. */
+		free_range (p, page_idx + page_cnt, ((size_t) 1 << order) - page_cnt);
+		ASSERT (bitmap_none (p->used_map, page_idx, page_cnt));
+		bitmap_set_multiple (p->used_map, page_idx, page_cnt, true);
+	}
+	return page_idx;
+}
+
+/* Allocates the PAGE_CNT pages starting at PAGE_IDX from P, if
+   they are all free, and returns true, or returns false if any
+   of them is in use.  Each free block that holds some of them is
+   split, and its other pages go back to the free lists.
+   Interrupts must be off. */
+static bool
+take_range (struct pool *p, size_t page_idx, size_t page_cnt) {
+	size_t end = page_idx + page_cnt;
+	size_t i;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (!bitmap_none (p->used_map, page_idx, page_cnt))
+		return false;
+
+	for (i = page_idx; i < end; ) {
+		size_t start = i, block_end;
+		int order = 0;
+
+		/* Find the free block that holds page I. */
+		while (p->orders[start] != order) {
+			order++;
+			ASSERT (order < ORDER_CNT);
+			start = i & ~(((size_t) 1 << order) - 1);
+		}
+		block_remove (p, start, order);
+
+		block_end = start + ((size_t) 1 << order);
+		free_range (p, start, i - start);
+		if (block_end > end) {
+			free_range (p, end, block_end - end);
+			block_end = end;
+		}
+		i = block_end;
+	}
+	bitmap_set_multiple (p->used_map, page_idx, page_cnt, true);
+	return true;
+}
+
+/* Allocates up to PAGE_CNT pages from P, as one block if one is
+   large enough or else page by page, stores their addresses in
+   PAGES, and returns how many it allocated.  Interrupts must be
+   off. */
+static size_t
+take_batch (struct pool *p, void **pages, size_t page_cnt) {
+	size_t page_idx, cnt;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (page_cnt == 0)
+		return 0;
+	page_idx = take_pages (p, page_cnt);
+	if (page_idx != BITMAP_ERROR) {
+		for (cnt = 0; cnt < page_cnt; cnt++)
+			pages[cnt] = p->base + PGSIZE * (page_idx + cnt);
+		return page_cnt;
+	}
+	for (cnt = 0; cnt < page_cnt; cnt++) {
+		page_idx = take_pages (p, 1);
+		if (page_idx == BITMAP_ERROR)
+			break;
+		pages[cnt] = p->base + PGSIZE * page_idx;
+	}
+	return cnt;
+}
+
+/* Returns the PAGE_CNT pages in PAGES to their pools' free
+   blocks.  Interrupts must be off. */
+static void
+release_batch (void **pages, size_t page_cnt) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (size_t i = 0; i < page_cnt; i++) {
+		struct pool *p = pool_of (pages[i]);
+		size_t page_idx = pg_no (pages[i]) - pg_no (p->base);
+
+		ASSERT (pg_ofs (pages[i]) == 0);
+		ASSERT (bitmap_test (p->used_map, page_idx));
+		ASSERT (p->orders[page_idx] != IN_MAGAZINE);
+		bitmap_reset (p->used_map, page_idx);
+		free_range (p, page_idx, 1);
+	}
+}
+
+/* Returns the PAGE_CNT user pages in PAGES, taken out of a
+   magazine, to the user pool's free blocks.  Interrupts must be
+   off. */
+static void
+magazine_release (void **pages, size_t page_cnt) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (size_t i = 0; i < page_cnt; i++)
+		user_pool.orders[pg_no (pages[i]) - pg_no (user_pool.base)] = NOT_FREE;
+	release_batch (pages, page_cnt);
+}
+
+/* Returns all of P's pre-zeroed pages to its free blocks.
+   Interrupts must be off. */
+static void
+drain_zeroed (struct pool *p) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while (!list_empty (&p->zeroed)) {
+		size_t page_idx = list_pop_front (&p->zeroed) - p->links;
+
+		bitmap_reset (p->used_map, page_idx);
+		free_range (p, page_idx, 1);
+	}
+	p->zeroed_cnt = 0;
+}
+
+/* Tops up each pool's pre-zeroed pages to ZEROED_MAX.  Runs on
+   the WORK_LOW queue, zeroing one page at a time with interrupts
+   on. */
+static void
+zero_fill (void *aux UNUSED) {
+	struct pool *pools[] = { &kernel_pool, &user_pool };
+
+	for (size_t i = 0; i < sizeof pools / sizeof *pools; i++) {
+		struct pool *p = pools[i];
+
+		for (;;) {
+			enum intr_level old_level = intr_disable ();
+			size_t page_idx = BITMAP_ERROR;
+
+			if (p->zeroed_cnt < ZEROED_MAX)
+				page_idx = take_pages (p, 1);
+			intr_set_level (old_level);
+			if (page_idx == BITMAP_ERROR)
+				break;
+
+			memset (p->base + PGSIZE * page_idx, 0, PGSIZE);
+
+			old_level = intr_disable ();
+			list_push_back (&p->zeroed, &p->links[page_idx]);
+			p->zeroed_cnt++;
+			intr_set_level (old_level);
+		}
+	}
+}
+
+/* Returns the pool that PAGE belongs to. */
+static struct pool *
+pool_of (void *page) {
+	if (page_from_pool (&kernel_pool, page))
+		return &kernel_pool;
+	else if (page_from_pool (&user_pool, page))
+		return &user_pool;
+	NOT_REACHED ();
+}
+
 /* Returns true if PAGE was allocated from POOL,
    false otherwise. */
 static bool
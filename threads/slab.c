@@ -0,0 +1,224 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Slab allocator.
+
+   Each cache owns a set of "slabs", pages obtained from the page
+   allocator.  A slab starts with a header, followed by a stack of
+   the indexes of its free objects, followed by the objects
+   themselves, packed at the cache's exact (word-aligned) object
+   size.  Keeping the free stack outside the objects means a free
+   object is never written to, so an object freed in its
+   constructed state stays constructed.
+
+   The cache keeps its slabs that have free objects on a list and
+   allocates from the first of them, adding a new slab when the
+   list is empty.  A slab that becomes full leaves the list, and a
+   slab that becomes empty goes back to the page allocator unless
+   it is the cache's last one, so that allocating and freeing a
+   single object does not repeatedly take and release a page.
+
+   Like malloc(), the slab of an object is found by rounding its
+   address down to a page boundary. */
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x51ab51ab
+
+/* Object cache. */
+struct kmem_cache {
+	const char *name;           /* Name, for statistics. */
+	size_t obj_size;            /* Size of each object, word-aligned. */
+	size_t objs_per_slab;       /* Number of objects in a slab. */
+	kmem_ctor *ctor;            /* Constructor, or null. */
+	struct list slabs;          /* Slabs with free objects. */
+	struct lock lock;           /* Lock. */
+	struct list_elem elem;      /* Element in cache_list. */
+
+	/* Statistics. */
+	size_t slab_cnt;            /* Slabs owned. */
+	size_t in_use;              /* Objects allocated. */
+	long long alloc_cnt;        /* Calls to kmem_cache_alloc(). */
+};
+
+/* Slab header, at the start of each slab's page. */
+struct slab {
+	unsigned magic;             /* Always set to SLAB_MAGIC. */
+	struct kmem_cache *cache;   /* Owning cache. */
+	struct list_elem elem;      /* Element in the cache's slab list. */
+	uint8_t *objs;              /* First object. */
+	size_t free_cnt;            /* Number of free objects. */
+	uint16_t free[];            /* Indexes of free objects, a stack. */
+};
+
+/* Every cache, for kmem_print_stats(). */
+static struct list cache_list;
+
+static struct slab *slab_create (struct kmem_cache *);
+static struct slab *obj_to_slab (void *obj);
+
+/* Initializes the slab allocator. */
+void
+kmem_init (void) {
+	list_init (&cache_list);
+}
+
+/* Creates and returns a cache of objects of SIZE bytes named NAME,
+   which must remain valid for as long as the cache exists.  If
+   CTOR is nonnull, it is run on each object when the object's
+   slab is created.  Returns a null pointer if memory is not
+   available. */
+struct kmem_cache *
+kmem_cache_create (const char *name, size_t size, kmem_ctor *ctor) {
+	struct kmem_cache *c;
+
+	ASSERT (name != NULL);
+	ASSERT (size > 0);
+
+	c = malloc (sizeof *c);
+	if (c == NULL)
+		return NULL;
+
+	c->name = name;
+	c->obj_size = ROUND_UP (size, sizeof (void *));
+	c->objs_per_slab = (PGSIZE - sizeof (struct slab) - sizeof (void *))
+		/ (c->obj_size + sizeof (uint16_t));
+	ASSERT (c->objs_per_slab > 0);
+	c->ctor = ctor;
+	list_init (&c->slabs);
+	lock_init (&c->lock);
+	c->slab_cnt = 0;
+	c->in_use = 0;
+	c->alloc_cnt = 0;
+	list_push_back (&cache_list, &c->elem);
+	return c;
+}
+
+/* Obtains and returns an object from cache C, or a null pointer
+   if memory is not available. */
+void *
+kmem_cache_alloc (struct kmem_cache *c) {
+	struct slab *s;
+	void *obj;
+
+	lock_acquire (&c->lock);
+	if (list_empty (&c->slabs)) {
+		s = slab_create (c);
+		if (s == NULL) {
+			lock_release (&c->lock);
+			return NULL;
+		}
+		list_push_front (&c->slabs, &s->elem);
+	}
+
+	s = list_entry (list_front (&c->slabs), struct slab, elem);
+	obj = s->objs + s->free[--s->free_cnt] * c->obj_size;
+	if (s->free_cnt == 0)
+		list_remove (&s->elem);
+	c->in_use++;
+	c->alloc_cnt++;
+	lock_release (&c->lock);
+	return obj;
+}
+
+/* Returns OBJ, which must have been allocated from cache C, to
+   C. */
+void
+kmem_cache_free (struct kmem_cache *c, void *obj) {
+	struct slab *s;
+
+	if (obj == NULL)
+		return;
+
+	s = obj_to_slab (obj);
+	ASSERT (s->cache == c);
+
+#ifndef NDEBUG
+	/* Clear the object to help detect use-after-free bugs, unless
+	   that would undo its constructor. */
+	if (c->ctor == NULL)
+		memset (obj, 0xcc, c->obj_size);
+#endif
+
+	lock_acquire (&c->lock);
+	if (s->free_cnt == 0)
+		list_push_front (&c->slabs, &s->elem);
+	s->free[s->free_cnt++] = ((uint8_t *) obj - s->objs) / c->obj_size;
+	c->in_use--;
+
+	/* Give an empty slab back, unless it is the last one. */
+	if (s->free_cnt == c->objs_per_slab
+			&& list_front (&c->slabs) != list_back (&c->slabs)) {
+		list_remove (&s->elem);
+		c->slab_cnt--;
+		palloc_free_page (s);
+	}
+	lock_release (&c->lock);
+}
+
+/* Prints the statistics of every cache. */
+void
+kmem_print_stats (void) {
+	struct list_elem *e;
+
+	for (e = list_begin (&cache_list); e != list_end (&cache_list);
+			e = list_next (e)) {
+		struct kmem_cache *c = list_entry (e, struct kmem_cache, elem);
+
+		printf ("Slab: %s: %zu-byte objects, %zu in use, %zu slabs, "
+				"%lld allocations\n", c->name, c->obj_size, c->in_use,
+				c->slab_cnt, c->alloc_cnt);
+	}
+}
+
+/* Obtains a page for a new slab of cache C, which must be locked,
+   and returns it with every object free and constructed.
+   Returns a null pointer if memory is not available. */
+static struct slab *
+slab_create (struct kmem_cache *c) {
+	struct slab *s;
+	size_t i;
+
+	s = palloc_get_page (0);
+	if (s == NULL)
+		return NULL;
+
+	s->magic = SLAB_MAGIC;
+	s->cache = c;
+	s->objs = (uint8_t *) s + ROUND_UP (sizeof *s
+			+ c->objs_per_slab * sizeof *s->free, sizeof (void *));
+	ASSERT (s->objs + c->objs_per_slab * c->obj_size <= (uint8_t *) s + PGSIZE);
+	s->free_cnt = c->objs_per_slab;
+	for (i = 0; i < c->objs_per_slab; i++) {
+		/* Hand out the lowest addresses first. */
+		s->free[i] = c->objs_per_slab - 1 - i;
+		if (c->ctor != NULL)
+			c->ctor (s->objs + i * c->obj_size);
+	}
+	c->slab_cnt++;
+	return s;
+}
+
+/* Returns the slab that OBJ is inside. */
+static struct slab *
+obj_to_slab (void *obj) {
+	struct slab *s = pg_round_down (obj);
+
+	/* Check that the slab is valid. */
+	ASSERT (s != NULL);
+	ASSERT (s->magic == SLAB_MAGIC);
+
+	/* Check that the object is properly aligned for the slab. */
+	ASSERT ((uint8_t *) obj >= s->objs);
+	ASSERT (((uint8_t *) obj - s->objs) % s->cache->obj_size == 0);
+
+	return s;
+}
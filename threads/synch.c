@@ -31,6 +31,80 @@
 #include <string.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "intrinsic.h"
+
+/* Number of times a waiter for a handoff lock polls the lock
+   while its holder is running elsewhere, before it blocks. */
+#define LOCK_SPIN_LIMIT 100
+
+static bool compare_wait_priority_desc (const struct rb_node *,
+		const struct rb_node *, void *aux);
+static void lock_grant (struct lock *, struct thread *);
+static bool lock_spin (struct lock *);
+static bool lock_down (struct lock *);
+static void lock_up (struct lock *);
+
+/* Initializes wait queue WQ to be empty. */
+void
+wait_queue_init (struct wait_queue *wq) {
+	ASSERT (wq != NULL);
+
+	rb_init (&wq->threads, compare_wait_priority_desc, NULL);
+}
+
+/* Returns true if no thread is waiting in WQ. */
+bool
+wait_queue_empty (const struct wait_queue *wq) {
+	return rb_empty (&wq->threads);
+}
+
+/* Adds T to WQ behind any waiters of the same priority. */
+void
+wait_queue_push (struct wait_queue *wq, struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (t->wait_queue == NULL);
+
+	t->wait_queue = wq;
+	rb_insert (&wq->threads, &t->wait_node);
+}
+
+/* Removes and returns the highest-priority thread in WQ, which
+   must not be empty. */
+struct thread *
+wait_queue_pop (struct wait_queue *wq) {
+	struct thread *t;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (!wait_queue_empty (wq));
+
+	t = rb_entry (rb_first (&wq->threads), struct thread, wait_node);
+	rb_remove (&wq->threads, &t->wait_node);
+	t->wait_queue = NULL;
+	return t;
+}
+
+/* Removes T from the wait queue it is in. */
+void
+wait_queue_remove (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (t->wait_queue != NULL);
+
+	rb_remove (&t->wait_queue->threads, &t->wait_node);
+	t->wait_queue = NULL;
+}
+
+/* Sets the priority of T, which is in a wait queue, to PRIORITY
+   and moves it to its new place there, behind the waiters that
+   already have that priority. */
+void
+wait_queue_set_priority (struct thread *t, int priority) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (t->wait_queue != NULL);
+
+	rb_remove (&t->wait_queue->threads, &t->wait_node);
+	t->priority = priority;
+	rb_insert (&t->wait_queue->threads, &t->wait_node);
+}
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -46,7 +120,7 @@ sema_init (struct semaphore *sema, unsigned value) {
 	ASSERT (sema != NULL);
 
 	sema->value = value;
-	list_init (&sema->waiters);
+	wait_queue_init (&sema->waiters);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -66,9 +140,8 @@ sema_down (struct semaphore *sema) {
 
 	old_level = intr_disable ();
 	while (sema->value == 0) {
-		// list_push_back (&sema->waiters, &thread_current ()->elem);
-		// NOTE: list_insert_ordered is used instead of list_push_back for priority scheduling.
-		list_insert_ordered(&sema->waiters, &thread_current ()->elem, (list_less_func *) &compare_thread_priority_desc, NULL);
+		// NOTE: wait queue는 priority 순으로 유지되므로 sema_up에서 정렬할 필요가 없다.
+		wait_queue_push (&sema->waiters, thread_current ());
 		thread_block ();
 	}
 	sema->value--;
@@ -112,12 +185,9 @@ sema_up (struct semaphore *sema) {
 
 	old_level = intr_disable ();
 
-	if (!list_empty (&sema->waiters)) {
-		// sort the sema waiters list in descending order of thread priority
-		list_sort(&sema->waiters, (list_less_func *) &compare_thread_priority_desc, NULL);
-		thread_unblock (list_entry (list_pop_front (&sema->waiters),
-                    struct thread, elem));
-	}
+	// wake the highest priority waiter, the first one in the wait queue
+	if (!wait_queue_empty (&sema->waiters))
+		thread_unblock (wait_queue_pop (&sema->waiters));
 	sema->value++;
 	thread_try_preempt();
 	intr_set_level (old_level);
@@ -179,6 +249,26 @@ lock_init (struct lock *lock) {
 
 	lock->holder = NULL;
 	sema_init (&lock->semaphore, 1);
+	lock->priority = -1;
+	lock->handoff = false;
+}
+
+/* Puts LOCK in handoff mode if HANDOFF is true, or back in the
+   default mode.  LOCK must not be held.
+
+   By default lock_release() frees LOCK and wakes its best waiter,
+   which must then compete for it again; on a hot lock the
+   releaser or a newcomer usually gets there first and the waiter
+   goes back to sleep.  In handoff mode lock_release() makes the
+   highest-priority waiter the holder before waking it, so waiters
+   are served in priority order, FIFO among equals, at the cost of
+   a context switch per contended acquisition. */
+void
+lock_set_handoff (struct lock *lock, bool handoff) {
+	ASSERT (lock != NULL);
+	ASSERT (lock->holder == NULL);
+
+	lock->handoff = handoff;
 }
 
 /* Acquires LOCK, sleeping until it becomes available if
@@ -195,29 +285,34 @@ lock_acquire (struct lock *lock) {
 	ASSERT (!intr_context ());
 	ASSERT (!lock_held_by_current_thread (lock));
 
+	// handoff lock의 holder가 다른 CPU에서 실행 중이면 잠깐 기다려 본다.
+	if (lock->handoff && lock_spin (lock) && lock_try_acquire (lock))
+		return;
+
 	//mlfqs 실행시 work load 줄이도록 먼저 실행
 	if (thread_mlfqs) {
-		sema_down (&lock->semaphore);
-		lock->holder = thread_current ();
+		if (!lock_down (lock))
+			lock->holder = thread_current ();
 		return;
 	}
 
 	struct thread *current_thread = thread_current();
+	enum intr_level old_level = intr_disable ();
 	if (lock->holder != NULL) {
 		// set the lock that the current thread is waiting for
 		current_thread->waiting_lock = lock;
 
-		// insert donor to the lock holder's donor list, sort by priority of donor in descending order
-		list_insert_ordered(&lock->holder->donors, &current_thread->donor_elem, (list_less_func *) &compare_donation_priority_desc, NULL);
-
-		// donate the priority to the lock holder
+		// donate the priority along the chain of lock holders
 		thread_donate_priority();
 	}
   
 	// wait for the lock is released by the current holder
-	sema_down (&lock->semaphore);
-	current_thread->waiting_lock = NULL;
-	lock->holder = thread_current ();
+	// handoff lock이면 release하는 thread가 이미 우리를 holder로 만들어 두었다.
+	if (!lock_down (lock)) {
+		current_thread->waiting_lock = NULL;
+		lock_grant (lock, current_thread);
+	}
+	intr_set_level (old_level);
 }
 
 /* Tries to acquires LOCK and returns true if successful or false
@@ -233,13 +328,113 @@ lock_try_acquire (struct lock *lock) {
 	ASSERT (lock != NULL);
 	ASSERT (!lock_held_by_current_thread (lock));
 
+	enum intr_level old_level = intr_disable ();
 	success = sema_try_down (&lock->semaphore);
 	if (success) {
-		lock->holder = thread_current ();
+		if (thread_mlfqs)
+			lock->holder = thread_current ();
+		else
+			lock_grant (lock, thread_current ());
 	}
+	intr_set_level (old_level);
 	return success;
 }
 
+/* Makes T, either the current thread or a waiter that LOCK is
+   being handed to, the holder of LOCK.  Threads still waiting for
+   LOCK now donate to T, so the highest of them becomes LOCK's
+   donation, and LOCK joins T's held locks.  A waiter being handed
+   LOCK was its highest-priority waiter, so the donation cannot
+   raise it.  Interrupts must be off. */
+static void
+lock_grant (struct lock *lock, struct thread *t) {
+	struct wait_queue *waiters = &lock->semaphore.waiters;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	lock->holder = t;
+	lock->priority = -1;
+	if (!wait_queue_empty (waiters))
+		lock->priority = rb_entry (rb_first (&waiters->threads),
+				struct thread, wait_node)->priority;
+	rb_insert (&t->held_locks, &lock->holder_elem);
+	if (t == thread_current ())
+		thread_update_priority ();
+}
+
+/* Polls LOCK for a short while as long as its holder is running
+   on another CPU, which is likely to release it soon, and returns
+   true if LOCK became free.  Returns false at once if the holder
+   is not running: on a uniprocessor that is always so, since we
+   are. */
+static bool
+lock_spin (struct lock *lock) {
+	for (int i = 0; i < LOCK_SPIN_LIMIT; i++) {
+		struct thread *holder = lock->holder;
+
+		if (holder == NULL)
+			return true;
+		if (holder->status != THREAD_RUNNING || holder == thread_current ())
+			return false;
+		pause ();
+	}
+	return false;
+}
+
+/* Waits for LOCK's semaphore.  Returns true if LOCK, a handoff
+   lock, was handed to us by lock_up() while we slept, so that we
+   already hold it, or false if we took it ourselves. */
+static bool
+lock_down (struct lock *lock) {
+	struct semaphore *sema = &lock->semaphore;
+	enum intr_level old_level;
+
+	if (!lock->handoff) {
+		sema_down (sema);
+		return false;
+	}
+
+	/* A handed-over lock keeps its value at 0, so unlike
+	   sema_down() we must not wait for it to turn positive. */
+	old_level = intr_disable ();
+	if (sema->value > 0) {
+		sema->value--;
+		intr_set_level (old_level);
+		return false;
+	}
+	wait_queue_push (&sema->waiters, thread_current ());
+	thread_block ();
+	intr_set_level (old_level);
+	ASSERT (lock->holder == thread_current ());
+	return true;
+}
+
+/* Ups LOCK's semaphore, or, if LOCK is a handoff lock with
+   waiters, makes the highest-priority waiter its holder and wakes
+   it.  The caller must already have given LOCK up. */
+static void
+lock_up (struct lock *lock) {
+	struct semaphore *sema = &lock->semaphore;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if (!lock->handoff || wait_queue_empty (&sema->waiters)) {
+		sema_up (sema);
+		intr_set_level (old_level);
+		return;
+	}
+
+	struct thread *next = wait_queue_pop (&sema->waiters);
+	next->waiting_lock = NULL;
+	if (thread_mlfqs)
+		lock->holder = next;
+	else
+		lock_grant (lock, next);
+	thread_unblock (next);
+	thread_try_preempt ();
+	intr_set_level (old_level);
+}
+
 /* Releases LOCK, which must be owned by the current thread.
    This is lock_release function.
 
@@ -251,28 +446,27 @@ lock_release (struct lock *lock) {
 	ASSERT (lock != NULL);
 	ASSERT (lock_held_by_current_thread (lock));
 	
-	// remove lock from the current thread's donor list
+	// remove lock from the current thread's held locks
 	struct thread* current_thread = thread_current();
 
 	//mlfqs 실행시 work load 줄이도록 먼저 실행
 	if(thread_mlfqs){
 		lock->holder = NULL;
-		sema_up (&lock->semaphore);
+		lock_up (lock);
 		return;
 	}
 
-	for (struct list_elem *e = list_begin(&current_thread->donors); e != list_end(&current_thread->donors); e = list_next(e)) {
-		struct thread *t = list_entry(e, struct thread, donor_elem);
-		if (t->waiting_lock == lock) {// thread가 기다리는 lock이 release되면 donor list에서 제거
-			list_remove(e);
-		}
-	}
+	// lock이 release되면 이 lock을 통해 받은 donation도 함께 사라진다.
+	enum intr_level old_level = intr_disable ();
+	rb_remove (&current_thread->held_locks, &lock->holder_elem);
+	lock->priority = -1;
 
 	// update the holder thread's priority of the lock
 	thread_update_priority ();
 	
 	lock->holder = NULL;
-	sema_up (&lock->semaphore);
+	lock_up (lock);
+	intr_set_level (old_level);
 }
  
 /* Returns true if the current thread holds LOCK, false
@@ -285,11 +479,205 @@ lock_held_by_current_thread (const struct lock *lock) {
 	return lock->holder == thread_current ();
 }
 
-/* One semaphore in a list. */
-struct semaphore_elem {
-	struct list_elem elem;              /* List element. */
-	struct semaphore semaphore;         /* This semaphore. */
-};
+/* Initializes RW as a readers-writer lock.  Any number of
+   threads may hold it for reading at once, or a single thread
+   may hold it for writing.
+
+   Writers are preferred: a writer that is waiting for readers to
+   leave holds RW's inner lock, so readers that arrive after it
+   wait until it is done.  Readers waiting behind a writer wait on
+   that inner lock and so donate their priority to the writer.
+   The writer in turn donates to every reader it waits for, through
+   the struct rwlock_hold each reader keeps in its held_locks, so a
+   low-priority reader cannot hold up a high-priority writer for
+   longer than its read takes.  Neither side may be acquired
+   recursively, and a thread may hold at most RWLOCK_HOLD_MAX
+   rwlocks for reading at once. */
+void
+rwlock_init (struct rwlock *rw) {
+	ASSERT (rw != NULL);
+
+	lock_init (&rw->lock);
+	rw->readers = 0;
+	list_init (&rw->holds);
+	rw->draining = false;
+	sema_init (&rw->drained, 0);
+}
+
+/* Acquires RW for reading, sleeping while a writer holds it or
+   is waiting for it.  This function may sleep, so it must not be
+   called within an interrupt handler. */
+void
+rwlock_acquire_read (struct rwlock *rw) {
+	struct thread *curr = thread_current ();
+	struct rwlock_hold *hold = NULL;
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+	ASSERT (!intr_context ());
+
+	for (int i = 0; i < RWLOCK_HOLD_MAX; i++)
+		if (curr->read_holds[i].rw == NULL) {
+			hold = &curr->read_holds[i];
+			break;
+		}
+	ASSERT (hold != NULL);
+
+	lock_acquire (&rw->lock);
+	old_level = intr_disable ();
+	rw->readers++;
+	hold->rw = rw;
+	hold->lock.holder = curr;
+	hold->lock.priority = -1;
+	list_push_back (&rw->holds, &hold->elem);
+	if (!thread_mlfqs)
+		rb_insert (&curr->held_locks, &hold->lock.holder_elem);
+	intr_set_level (old_level);
+	lock_release (&rw->lock);
+}
+
+/* Releases RW, which the current thread holds for reading.  The
+   last reader out lets a waiting writer in. */
+void
+rwlock_release_read (struct rwlock *rw) {
+	struct thread *curr = thread_current ();
+	struct rwlock_hold *hold = NULL;
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+
+	for (int i = 0; i < RWLOCK_HOLD_MAX; i++)
+		if (curr->read_holds[i].rw == rw) {
+			hold = &curr->read_holds[i];
+			break;
+		}
+	ASSERT (hold != NULL);
+
+	old_level = intr_disable ();
+	ASSERT (rw->readers > 0);
+	list_remove (&hold->elem);
+	hold->rw = NULL;
+	hold->lock.holder = NULL;
+	if (!thread_mlfqs) {
+		rb_remove (&curr->held_locks, &hold->lock.holder_elem);
+		thread_update_priority ();
+	}
+	if (--rw->readers == 0 && rw->draining)
+		sema_up (&rw->drained);
+	else
+		thread_try_preempt ();
+	intr_set_level (old_level);
+}
+
+/* Acquires RW for writing, sleeping until no other thread holds
+   it.  This function may sleep, so it must not be called within
+   an interrupt handler. */
+void
+rwlock_acquire_write (struct rwlock *rw) {
+	struct thread *curr = thread_current ();
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+	ASSERT (!intr_context ());
+
+	lock_acquire (&rw->lock);
+	old_level = intr_disable ();
+	if (rw->readers > 0) {
+		rw->draining = true;
+		curr->draining_rwlock = rw;
+		if (!thread_mlfqs)
+			rwlock_donate (rw, curr->priority);
+		sema_down (&rw->drained);
+		curr->draining_rwlock = NULL;
+		rw->draining = false;
+	}
+	intr_set_level (old_level);
+}
+
+/* Releases RW, which the current thread holds for writing. */
+void
+rwlock_release_write (struct rwlock *rw) {
+	ASSERT (rw != NULL);
+	ASSERT (rw->readers == 0);
+
+	lock_release (&rw->lock);
+}
+
+/* Donates PRIORITY to every thread that holds RW for reading, on
+   behalf of a writer waiting for them to leave.  Interrupts must
+   be off. */
+void
+rwlock_donate (struct rwlock *rw, int priority) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (struct list_elem *e = list_begin (&rw->holds); e != list_end (&rw->holds);
+			e = list_next (e))
+		thread_donate_to_lock (&list_entry (e, struct rwlock_hold, elem)->lock,
+				priority);
+}
+
+/* Initializes SL as a sequence lock.  Writers never wait for
+   readers: they bump the sequence number before and after each
+   update, and a reader that sees it change, or sees it odd,
+   retries its read.  A read looks like this:
+
+	unsigned seq;
+	do {
+		seq = seqlock_read_begin (&sl);
+		...copy the protected data...
+	} while (seqlock_read_retry (&sl, seq));
+
+   Readers take no lock and may run in an interrupt handler.
+   Writers run with interrupts off, which also keeps them from
+   racing each other, so they should be brief. */
+void
+seqlock_init (struct seqlock *sl) {
+	ASSERT (sl != NULL);
+
+	sl->sequence = 0;
+}
+
+/* Starts a read of the data protected by SL and returns the
+   sequence number to hand to seqlock_read_retry(). */
+unsigned
+seqlock_read_begin (const struct seqlock *sl) {
+	unsigned seq;
+
+	while ((seq = *(volatile const unsigned *) &sl->sequence) & 1)
+		continue;
+	barrier ();
+	return seq;
+}
+
+/* Returns true if a write to SL may have overlapped the read that
+   began with sequence number START, in which case the read must
+   be repeated. */
+bool
+seqlock_read_retry (const struct seqlock *sl, unsigned start) {
+	barrier ();
+	return *(volatile const unsigned *) &sl->sequence != start;
+}
+
+/* Starts an update of the data protected by SL. */
+void
+seqlock_write_begin (struct seqlock *sl) {
+	enum intr_level old_level = intr_disable ();
+
+	ASSERT (!(sl->sequence & 1));
+	sl->old_level = old_level;
+	sl->sequence++;
+	barrier ();
+}
+
+/* Finishes an update of the data protected by SL. */
+void
+seqlock_write_end (struct seqlock *sl) {
+	ASSERT (sl->sequence & 1);
+
+	barrier ();
+	sl->sequence++;
+	intr_set_level (sl->old_level);
+}
 
 /* Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
@@ -298,7 +686,7 @@ void
 cond_init (struct condition *cond) {
 	ASSERT (cond != NULL);
 
-	list_init (&cond->waiters);
+	wait_queue_init (&cond->waiters);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -323,18 +711,24 @@ cond_init (struct condition *cond) {
    we need to sleep. */
 void
 cond_wait (struct condition *cond, struct lock *lock) {
-	struct semaphore_elem waiter;
+	struct thread *curr = thread_current ();
+	enum intr_level old_level;
 
 	ASSERT (cond != NULL);
 	ASSERT (lock != NULL);
 	ASSERT (!intr_context ());
 	ASSERT (lock_held_by_current_thread (lock));
 
-	sema_init (&waiter.semaphore, 0);
-	// list_push_back (&cond->waiters, &waiter.elem);
-	list_insert_ordered(&cond->waiters, &waiter.elem, (list_less_func *) &compare_sema_priority_desc, NULL);
+	/* Join the queue before releasing LOCK so that no signal is
+	   missed.  Releasing LOCK may let the signaler run before we
+	   block; it then takes us off the queue without waking us, and
+	   there is nothing left to wait for. */
+	old_level = intr_disable ();
+	wait_queue_push (&cond->waiters, curr);
 	lock_release (lock);
-	sema_down (&waiter.semaphore);
+	while (curr->wait_queue != NULL)
+		thread_block ();
+	intr_set_level (old_level);
 	lock_acquire (lock);
 }
 
@@ -352,11 +746,14 @@ cond_signal (struct condition *cond, struct lock *lock UNUSED) {
 	ASSERT (!intr_context ());
 	ASSERT (lock_held_by_current_thread (lock));
 
-	if (!list_empty (&cond->waiters)) {
-		list_sort(&cond->waiters, (list_less_func *) &compare_sema_priority_desc, NULL);
-		sema_up (&list_entry (list_pop_front (&cond->waiters),
-					struct semaphore_elem, elem)->semaphore);
+	enum intr_level old_level = intr_disable ();
+	if (!wait_queue_empty (&cond->waiters)) {
+		struct thread *t = wait_queue_pop (&cond->waiters);
+		if (t->status == THREAD_BLOCKED)
+			thread_unblock (t);
 	}
+	intr_set_level (old_level);
+	thread_try_preempt ();
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -370,62 +767,14 @@ cond_broadcast (struct condition *cond, struct lock *lock) {
 	ASSERT (cond != NULL);
 	ASSERT (lock != NULL);
 
-	while (!list_empty (&cond->waiters))
+	while (!wait_queue_empty (&cond->waiters))
 		cond_signal (cond, lock);
 }
 
-/* Compare the priority of two threads. */
-bool
-compare_thread_priority_desc(
-		struct list_elem *a,
-		struct list_elem *b,
-		void *aux UNUSED)
-{
-	struct thread *thread_a = list_entry(a, struct thread, elem);
-	struct thread *thread_b = list_entry(b, struct thread, elem);
-	return thread_a->priority > thread_b->priority;
+/* Orders waiting threads by priority, highest first. */
+static bool
+compare_wait_priority_desc (const struct rb_node *a, const struct rb_node *b,
+		void *aux UNUSED) {
+	return rb_entry (a, struct thread, wait_node)->priority
+		> rb_entry (b, struct thread, wait_node)->priority;
 }
-
-
-/* Lab #1 - check the local_ticks and make it ascending order*/
-bool
-compare_local_tick_asc(
-		struct list_elem *a,
-		struct list_elem *b,
-		void *aux UNUSED)
-{
-	struct thread *thread_a = list_entry(a, struct thread, elem);
-	struct thread *thread_b = list_entry(b, struct thread, elem);
-	return thread_a->local_tick < thread_b->local_tick;
-}
-
-/* compare the priority of two semaphores. */
-bool 
-compare_sema_priority_desc (struct list_elem *a, struct list_elem *b, void *aux UNUSED)
-{
-	// get the semaphore from the list element memory address
-	struct semaphore_elem *a_sema = list_entry (a, struct semaphore_elem, elem);
-	struct semaphore_elem *b_sema = list_entry (b, struct semaphore_elem, elem);
-
-	// waiters of sema contains the list of threads waiting for the semaphore
-	// waiters are sorted in descending order of priority by sema_up, first element has the highest priority
-	// get waiters of sema a and b
-	struct list *waiter_a_sema = &(a_sema->semaphore.waiters);
-	struct list *waiter_b_sema = &(b_sema->semaphore.waiters);
-
-	// compare the priority of the first thread in the waiters list of sema a and b, which has the highest priority
-	return list_entry (list_begin (waiter_a_sema), struct thread, elem)->priority
-		 > list_entry (list_begin (waiter_b_sema), struct thread, elem)->priority;
-}
-
-/* Compare the priority of two threads in the donor list. */
-bool
-compare_donation_priority_desc(
-		struct list_elem *a,
-		struct list_elem *b,
-		void *aux UNUSED)
-{
-	struct thread *donor_thread_a = list_entry(a, struct thread, donor_elem);
-	struct thread *donor_thread_b = list_entry(b, struct thread, donor_elem);
-	return donor_thread_a->priority > donor_thread_b->priority;
-}
\ No newline at end of file
@@ -7,10 +7,13 @@
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
+#include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
 #include "intrinsic.h"
+#include "devices/timer.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #endif
@@ -24,19 +27,107 @@
    Do not modify this value. */
 #define THREAD_BASIC 0xd42df210
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
+/* Scheduler state.
+
+   The run queue holds processes in THREAD_READY state, that is,
+   processes that are ready to run but not actually running.
+   There is one FIFO list per priority level, and bit P of
+   ready_mask is set exactly when ready_queues[P] is non-empty, so
+   the highest ready priority is found with a single bit scan.
+   Threads in the deadline class are kept apart in dl_queue,
+   ordered by absolute deadline, and always run before any
+   priority queue.  Those that have used up their budget wait in
+   dl_throttled until their deadline passes.
+
+   Under the completely fair scheduler the priority queues are
+   unused; other threads wait in cfs_queue, a red-black tree keyed
+   by vruntime, and the leftmost one runs next. */
+static struct list ready_queues[PRI_MAX + 1];
+static uint64_t ready_mask;
+static struct list dl_queue;    /* Ready EDF threads, earliest deadline first. */
+static struct list dl_throttled;  /* Ready EDF threads out of budget. */
+static struct rb_tree cfs_queue;  /* Ready CFS threads, by vruntime. */
+static int64_t cfs_load;        /* Sum of weights in cfs_queue. */
+static int64_t min_vruntime;    /* Monotonic floor of vruntime. */
+static size_t ready_cnt;        /* # of runnable threads in all queues. */
 
-/* Lab #1 - sleep_list : running 되던 thread가 timer_sleep()을 만나면 이 list에 들어가게 됨.*/
-static struct list sleep_list;
+/* Idle thread. */
+static struct thread *idle_thread;
+
+/* Pages of dead threads are kept in thread_cache, up to
+   THREAD_CACHE_MAX of them, for thread_create() to reuse.  That
+   skips the page allocator and the zeroing of the whole page:
+   init_thread() clears only the struct thread. */
+#define THREAD_CACHE_MAX 8
+static struct list thread_cache;
+static size_t thread_cache_cnt; /* # of pages in thread_cache. */
+
+/* Lab #1 - sleep wheel : running 되던 thread가 timer_sleep()을 만나면 이 wheel에 들어가게 됨.
+   Hierarchical timing wheel.  The root wheel has one slot per tick
+   for the next WHEEL_ROOT_SIZE ticks; each outer level covers
+   WHEEL_SIZE times the span of the level below it.  When the root
+   wheel wraps, the current slot of the next level is cascaded
+   down, so both insertion and expiry are O(1) amortized. */
+#define WHEEL_ROOT_BITS 8
+#define WHEEL_ROOT_SIZE (1 << WHEEL_ROOT_BITS)
+#define WHEEL_ROOT_MASK (WHEEL_ROOT_SIZE - 1)
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4          /* # of levels above the root wheel. */
+
+static struct list wheel_root[WHEEL_ROOT_SIZE];
+static struct list wheel[WHEEL_LEVELS][WHEEL_SIZE];
+static struct list wheel_overflow;  /* Sleepers beyond the last level. */
+static int64_t wheel_tick;          /* Next tick to be expired. */
+
+/* Deadline class admission control.  Bandwidth is runtime/period
+   in units of 1/DL_BW_UNIT; the sum over all EDF threads may not
+   exceed DL_BW_LIMIT, leaving the rest of the CPU to the
+   priority classes. */
+#define DL_BW_UNIT (1 << 20)
+#define DL_BW_LIMIT (DL_BW_UNIT / 100 * 95)
+static int64_t dl_total_bw;
+
+/* CPU bandwidth control group, in the style of cgroup cpu.max.
+   Threads in a group may run for at most QUOTA ticks in total per
+   PERIOD ticks.  Once the quota is used up the group is throttled
+   and its ready threads are parked on its own list, off every run
+   queue, until the next period starts.  A thread joins its
+   creator's group; threads that never asked for a limit share
+   root_cpu_group, which is unlimited. */
+struct cpu_group {
+	int64_t quota;              /* Ticks per period, or -1 for no limit. */
+	int64_t period;             /* Period length, in ticks. */
+	int64_t period_start;       /* Tick at which the current period began. */
+	int64_t usage;              /* Ticks used in the current period. */
+	bool throttled;             /* Quota used up for this period. */
+	int64_t throttled_since;    /* Tick at which throttling began. */
+	int64_t throttled_ticks;    /* Total ticks spent throttled. */
+	struct list parked;         /* Ready threads held back while throttled. */
+	struct list_elem elem;      /* Element in limited_groups. */
+	int ref_cnt;                /* # of threads in the group. */
+};
+
+static struct cpu_group root_cpu_group;
+static struct list limited_groups;  /* Groups with a quota. */
 
 /* Lab #1 - mlfqs_list : mlfqs에서 사용하기 위한 list.*/
 static struct list mlfqs_list;
 
+/* Lazy recent_cpu decay.  Every second starts a new decay epoch
+   whose coefficient 2*load_avg / (2*load_avg + 1) is remembered in
+   decay_coef.  A thread applies the epochs it missed only when it
+   is next enqueued or picked to run, and a cursor walks mlfqs_list
+   a few threads per tick so that waiting threads do not fall too
+   far behind.  Nothing sweeps the whole list inside the timer
+   interrupt. */
+#define DECAY_HISTORY 64        /* # of epoch coefficients remembered. */
+#define DECAY_BATCH 8           /* # of threads caught up per tick. */
+static int64_t decay_epoch;
+static int decay_coef[DECAY_HISTORY];
+static struct list_elem *decay_cursor;
 
-/* Idle thread. */
-static struct thread *idle_thread;
 
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
@@ -52,8 +143,19 @@ static long long idle_ticks;    /* # of timer ticks spent idle. */
 static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
 static long long user_ticks;    /* # of timer ticks in user programs. */
 
-/* Lab #1 - global_tick 정의*/
-static int64_t global_tick;
+/* Every thread that has not yet exited, for the statistics dump. */
+static struct list all_list;
+
+/* Per-thread scheduling statistics.  schedule() charges the time
+   a thread spent in the ready queue to its run_delay and counts
+   the switch away from the previous thread as voluntary if it
+   blocked or involuntary if it was still ready; thread_tick()
+   charges each tick to user or kernel time by the mode the timer
+   interrupted.  If true, each thread's statistics are printed
+   when it exits and at power off. */
+bool thread_schedstats;
+
+static void print_sched_stats (const struct thread *);
 
 /* Scheduling. */
 #define TIME_SLICE 4            /* # of timer ticks to give each thread. */
@@ -64,6 +166,34 @@ static unsigned thread_ticks;   /* # of timer ticks since last yield. */
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* Completely fair scheduler.  Each tick a thread runs adds
+   CFS_NICE_0_WEIGHT * CFS_VRT_SCALE / weight to its vruntime, so
+   a nice-0 thread's vruntime counts ticks in 1/CFS_VRT_SCALE units
+   and heavier threads age more slowly.  Every ready thread should
+   run once per CFS_LATENCY ticks, each for a share of that period
+   proportional to its weight. */
+bool thread_cfs;
+
+#define CFS_VRT_SCALE 1024
+#define CFS_NICE_0_WEIGHT 1024
+#define CFS_LATENCY 8                           /* Target period, in ticks. */
+#define CFS_MIN_GRANULARITY 1                   /* Shortest slice, in ticks. */
+#define CFS_WAKEUP_GRANULARITY CFS_VRT_SCALE    /* Lead needed to preempt. */
+
+/* Weight of each nice value from NICE_MIN to NICE_MAX.  Each step
+   is worth about 10% of CPU time against a nice-0 thread. */
+static const int cfs_nice_weight[NICE_MAX - NICE_MIN + 1] = {
+	/* -20 */ 88761, 71755, 56483, 46273, 36291,
+	/* -15 */ 29154, 23254, 18705, 14949, 11916,
+	/* -10 */ 9548, 7620, 6100, 4904, 3906,
+	/*  -5 */ 3121, 2501, 1991, 1586, 1277,
+	/*   0 */ 1024, 820, 655, 526, 423,
+	/*   5 */ 335, 272, 215, 172, 137,
+	/*  10 */ 110, 87, 70, 56, 45,
+	/*  15 */ 36, 29, 23, 18, 15,
+	/*  20 */ 12,
+};
+
 int load_avg;
 
 static void kernel_thread (thread_func *, void *aux);
@@ -74,6 +204,31 @@ static void init_thread (struct thread *, const char *name, int priority);
 static void do_schedule(int status);
 static void schedule (void);
 static tid_t allocate_tid (void);
+static struct thread *thread_page_alloc (void);
+static void thread_page_free (struct thread *);
+static void ready_queue_push (struct thread *);
+static void ready_queue_remove (struct thread *);
+static struct thread *ready_queue_highest (void);
+static void thread_requeue (struct thread *, int priority);
+static void wheel_insert (struct thread *);
+static void wheel_requeue (struct list *);
+static int wheel_cascade (int level);
+static void advanced_decay_catch_up (struct thread *);
+static bool thread_preempts (const struct thread *, const struct thread *);
+static bool compare_dl_deadline_asc (const struct list_elem *,
+		const struct list_elem *, void *aux UNUSED);
+static int64_t dl_bandwidth (const struct thread *);
+static void dl_wakeup (struct thread *);
+static void dl_replenish (void);
+static bool compare_vruntime_less (const struct rb_node *,
+		const struct rb_node *, void *aux UNUSED);
+static bool compare_lock_priority_desc (const struct rb_node *,
+		const struct rb_node *, void *aux UNUSED);
+static int cfs_weight (const struct thread *);
+static unsigned cfs_slice (const struct thread *);
+static void cfs_update_min_vruntime (void);
+static void cpu_group_refill (void);
+static void cpu_group_unthrottle (struct cpu_group *);
 
 /* Returns true if T appears to point to a valid thread. */
 #define is_thread(t) ((t) != NULL && (t)->magic == THREAD_MAGIC)
@@ -119,18 +274,38 @@ thread_init (void) {
 
 	/* Init the globla thread context */
 	lock_init (&tid_lock);
-	list_init (&ready_list);
-	list_init (&sleep_list);
+	for (int i = PRI_MIN; i <= PRI_MAX; i++)
+		list_init (&ready_queues[i]);
+	ready_mask = 0;
+	list_init (&dl_queue);
+	list_init (&dl_throttled);
+	rb_init (&cfs_queue, compare_vruntime_less, NULL);
+	cfs_load = 0;
+	min_vruntime = 0;
+	dl_total_bw = 0;
+	ready_cnt = 0;
+	list_init (&thread_cache);
+	thread_cache_cnt = 0;
+	for (int i = 0; i < WHEEL_ROOT_SIZE; i++)
+		list_init (&wheel_root[i]);
+	for (int level = 0; level < WHEEL_LEVELS; level++)
+		for (int i = 0; i < WHEEL_SIZE; i++)
+			list_init (&wheel[level][i]);
+	list_init (&wheel_overflow);
+	wheel_tick = 0;
+	root_cpu_group.quota = -1;
+	list_init (&root_cpu_group.parked);
+	list_init (&limited_groups);
 	list_init (&mlfqs_list);
+	decay_epoch = 0;
+	decay_cursor = NULL;
 	list_init (&destruction_req);
-
-	/* Lab #1 - 이곳에서 다른 global들도 init됨. -> global_tick도 여기서 init*/
-
-	global_tick = INT64_MAX;
+	list_init (&all_list);
 
 	/* Set up a thread structure for the running thread. */
 	initial_thread = running_thread ();
 	init_thread (initial_thread, "main", PRI_DEFAULT);
+	list_push_back (&all_list, &initial_thread->all_elem);
 
 	list_push_back (&mlfqs_list, &initial_thread->mlfqs_elem);
 	initial_thread->status = THREAD_RUNNING;
@@ -156,10 +331,11 @@ thread_start (void) {
 	sema_down (&idle_started);
 }
 
-/* Called by the timer interrupt handler at each timer tick.
+/* Called by the timer interrupt handler at each timer tick, with
+   USER true if the tick interrupted user mode.
    Thus, this function runs in an external interrupt context. */
 void
-thread_tick (void) {
+thread_tick (bool user) {
 	struct thread *t = thread_current ();
 
 	/* Update statistics. */
@@ -171,17 +347,77 @@ thread_tick (void) {
 #endif
 	else
 		kernel_ticks++;
+	if (user)
+		t->stats.user_ticks++;
+	else
+		t->stats.kernel_ticks++;
+
+	/* Charge the deadline class.  A thread that runs out of
+	   budget is throttled until its deadline. */
+	if (t->dl_runtime != 0 && --t->dl_budget <= 0) {
+		t->dl_throttled = true;
+		intr_yield_on_return ();
+	}
+	if (!list_empty (&dl_throttled))
+		dl_replenish ();
+
+	/* Charge the thread's group and throttle it once the quota
+	   for this period is spent. */
+	if (t != idle_thread && t->cpu_group->quota >= 0
+			&& ++t->cpu_group->usage >= t->cpu_group->quota
+			&& !t->cpu_group->throttled) {
+		t->cpu_group->throttled = true;
+		t->cpu_group->throttled_since = timer_ticks ();
+		intr_yield_on_return ();
+	}
+	if (!list_empty (&limited_groups))
+		cpu_group_refill ();
+
+	/* Age the running thread by its weight. */
+	if (thread_cfs && t != idle_thread && t->dl_runtime == 0) {
+		t->vruntime += CFS_NICE_0_WEIGHT * CFS_VRT_SCALE / cfs_weight (t);
+		cfs_update_min_vruntime ();
+	}
 
 	/* Enforce preemption. */
-	if (++thread_ticks >= TIME_SLICE)
+	if (++thread_ticks >= (thread_cfs ? cfs_slice (t) : TIME_SLICE))
 		intr_yield_on_return ();
 }
 
-/* Prints thread statistics. */
+/* Accounts for CNT timer ticks that passed while the idle thread
+   was halted with the periodic tick stopped. */
+void
+thread_tick_idle (int64_t cnt) {
+	idle_ticks += cnt;
+}
+
+/* Prints thread statistics, and with -schedstats the scheduling
+   statistics of every thread still alive. */
 void
 thread_print_stats (void) {
+	enum intr_level old_level;
+	struct list_elem *e;
+
 	printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
 			idle_ticks, kernel_ticks, user_ticks);
+	if (!thread_schedstats)
+		return;
+
+	old_level = intr_disable ();
+	for (e = list_begin (&all_list); e != list_end (&all_list); e = list_next (e))
+		print_sched_stats (list_entry (e, struct thread, all_elem));
+	intr_set_level (old_level);
+}
+
+/* Prints T's scheduling statistics on one line. */
+static void
+print_sched_stats (const struct thread *t) {
+	printf ("Schedstat: %s (tid %d): %lld ns run delay, %lld wakeups, "
+			"%lld voluntary and %lld involuntary switches, "
+			"%lld user ticks, %lld kernel ticks\n",
+			t->name, t->tid, t->stats.run_delay, t->stats.wakeups,
+			t->stats.voluntary_switches, t->stats.involuntary_switches,
+			t->stats.user_ticks, t->stats.kernel_ticks);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -208,18 +444,34 @@ thread_create (const char *name, int priority,
 	ASSERT (function != NULL);
 
 	/* Allocate thread. */
-	t = palloc_get_page (PAL_ZERO);
+	t = thread_page_alloc ();
 	if (t == NULL)
 		return TID_ERROR;
 
 	/* Initialize thread. */
 	init_thread (t, name, priority);
 
+	// Initialize fd table
+	// Done before T is registered anywhere, so that failure only has
+	// to give back its page.
+	#ifdef USERPROG
+	t->fd_table = (struct list*) malloc(sizeof(struct list));
+	if (t->fd_table == NULL) {
+		enum intr_level old_level = intr_disable ();
+		thread_page_free (t);
+		intr_set_level (old_level);
+		return TID_ERROR;
+	}
+
+	list_init(t->fd_table);
+	#endif
+
 	if (thread_mlfqs) {
 		struct thread *curr_thread = thread_current ();
 		//현재 쓰레드의 nice, recent_cpu를 새로운 쓰레드에 복사
 		t->nice = curr_thread->nice;
 		t->recent_cpu = curr_thread->recent_cpu;
+		t->decay_epoch = curr_thread->decay_epoch;
 
 		//새로운 쓰레드의 priority를 계산
 		advanced_priority_calculation(t);
@@ -229,6 +481,19 @@ thread_create (const char *name, int priority,
 			list_push_back(&mlfqs_list, &t->mlfqs_elem);
 	}
 
+	/* Charge the new thread to its creator's group. */
+	enum intr_level old_level = intr_disable ();
+	t->cpu_group = thread_current ()->cpu_group;
+	t->cpu_group->ref_cnt++;
+	list_push_back (&all_list, &t->all_elem);
+	intr_set_level (old_level);
+
+	/* A new thread starts level with the least-served ready thread. */
+	if (thread_cfs) {
+		t->nice = thread_current ()->nice;
+		t->vruntime = min_vruntime;
+	}
+
 	tid = t->tid = allocate_tid ();
 
 	/* Call the kernel_thread if it scheduled.
@@ -242,17 +507,6 @@ thread_create (const char *name, int priority,
 	t->tf.cs = SEL_KCSEG;
 	t->tf.eflags = FLAG_IF;
 
-	// Initialize fd table
-	#ifdef USERPROG
-	t->fd_table = (struct list*) malloc(sizeof(struct list));
-	if (t->fd_table == NULL) {
-		return TID_ERROR;
-	}
-
-	list_init(t->fd_table);
-	#endif
-
-
 	// fork시 thread_current()는 parent thread
 	// t는 새로 생성되는 child thread
 	t->parent = thread_current ();
@@ -300,22 +554,36 @@ thread_unblock (struct thread *t) {
 
 	old_level = intr_disable ();
 	ASSERT (t->status == THREAD_BLOCKED);
-	// list_push_back (&ready_list, &t->elem);
-	list_insert_ordered(&ready_list, &t->elem, (list_less_func *) &compare_thread_priority_desc, NULL);
+	if (thread_mlfqs)
+		advanced_decay_catch_up (t);
+	if (t->dl_runtime != 0)
+		dl_wakeup (t);
+	else if (thread_cfs) {
+		/* A thread that slept gets at most half a period of credit
+		   over the threads that kept running. */
+		int64_t floor = min_vruntime - CFS_LATENCY * CFS_VRT_SCALE / 2;
+		if (t->vruntime < floor)
+			t->vruntime = floor;
+	}
+	/* A thread that has never run is being started, not woken. */
+	if (t->switch_rsp != 0)
+		t->stats.wakeups++;
+	t->ready_since = timer_ns ();
 	t->status = THREAD_READY;
+	ready_queue_push (t);
 	intr_set_level (old_level);
 }
 /* Lab #1 - 이거 수정하는 줄 알았는데 아니었다.
 새로 thread를 sleep_list로 넣어주는 함수를 만들고 그 함수에서 block과 unblock을 사용하는 듯 하다.*/
 
-/* Lab #1 - 쓰레드를 sleep_list로 보내는 작용
+/* Lab #1 - 쓰레드를 sleep wheel로 보내는 작용
 해야할 task 목록
 1. timer_sleep에게 호출당함
 2. idle인지 확인부터 해야 함
 3. 인터럽트 막도록 해야함
 4. 외부 인터럽트 체크
 5. local tick
-6. sleep_list에 넣어주기
+6. sleep wheel에 넣어주기
 7. block
 8. 인터럽트 해제*/
 void
@@ -348,14 +616,9 @@ thread_sleep (int64_t ticks) {
 
 	/* local_tick에 현재 ticks를 넣어주면서*/
 	curr_thread -> local_tick = ticks;
-	/* 이 local_tick이 global_tick보다 작은지 체크하고, global_tick을 가장 작은 값으로 재정의 시켜야 한다.*/
-	if (curr_thread->local_tick < global_tick) {
-		global_tick = curr_thread->local_tick;
-	}
 
-	// sleep_list를 local_tick을 기준으로 오름차순하여 정렬
-	//list_push_back(&sleep_list, &curr_thread->elem);
-	list_insert_ordered(&sleep_list, &curr_thread->elem, (list_less_func *) &compare_local_tick_asc, NULL);
+	// local_tick에 해당하는 wheel slot에 O(1)로 넣어준다. 정렬 불필요.
+	wheel_insert (curr_thread);
 
 	/*이제 block을 시켜야 한다.*/
 	thread_block();
@@ -364,62 +627,152 @@ thread_sleep (int64_t ticks) {
 	intr_set_level(old_level);
 }
 
-/* Lab #1 - 쓰레드를 sleep_list에서 ready_list로 보내는 작용*/
+/* Lab #1 - 쓰레드를 sleep wheel에서 ready queue로 보내는 작용
+   Expires every wheel slot up to and including TICK.  Called
+   once per timer tick, so the loop normally runs a single time. */
 void
 thread_wake(int64_t tick) {
-	/*global tick 변수 사용하고.*/
-	global_tick = INT64_MAX;
-
-	/*list 변수 사용*/
-	struct list_elem *element_from_sleep_list;
-	/*슬립 리스트의 요소 처음 것 take.*/
-	element_from_sleep_list = list_begin(&sleep_list);
-
-	/*리스트의 끝까지 원소 하나하나 체크.
-	다만, list 정렬된 상태이기에 wake up할 시간이 안 된 쓰레드를 처음 만난 이후부터는 확인할 필요 없음-> break*/
-	while (element_from_sleep_list != list_end(&sleep_list)) {
-		struct thread *cur = list_entry(element_from_sleep_list, struct thread, elem);
-
-		//해당 파트에서는 cur의 local_tick이 제시된 tick보다 작거나 같으면
-		if (cur->local_tick <= tick) {
-			//해당 리스트에서 제거.
-			element_from_sleep_list = list_remove(&cur->elem);
-			thread_unblock(cur);
+	while (wheel_tick <= tick) {
+		int index = wheel_tick & WHEEL_ROOT_MASK;
+
+		/* root wheel이 한 바퀴 돌았으면 상위 level의 slot을 내려준다. */
+		if (index == 0) {
+			int level;
+			for (level = 0; level < WHEEL_LEVELS; level++)
+				if (wheel_cascade (level) != 0)
+					break;
+			if (level == WHEEL_LEVELS)
+				wheel_requeue (&wheel_overflow);
 		}
-		else {
-			/* wakeup하지 않아도 되는 쓰레드 만날 경우 : global tick update 해주고, break */
-			//element_from_sleep_list = list_next(element_from_sleep_list);
-			if (cur->local_tick < global_tick) {
-				global_tick = cur->local_tick;
-			}
 
-			break;
+		/* 해당 slot의 쓰레드는 모두 local_tick == wheel_tick 이므로 전부 깨운다. */
+		struct list *slot = &wheel_root[index];
+		while (!list_empty (slot)) {
+			struct thread *cur = list_entry (list_pop_front (slot), struct thread, elem);
+			thread_unblock (cur);
+		}
+		wheel_tick++;
+	}
+}
+
+/* Returns the earliest tick, but no later than LIMIT, on which
+   the timer has work to do: a sleeper expires, the root wheel
+   wraps and the outer levels must be cascaded, or a throttled EDF
+   thread or CPU group is refilled.  Sleepers in the outer levels never expire
+   before that wrap, so only the root wheel needs to be scanned.
+   Interrupts must be off. */
+int64_t
+thread_next_wakeup (int64_t limit) {
+	struct list *throttled = &dl_throttled;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (struct list_elem *e = list_begin (throttled); e != list_end (throttled);
+			e = list_next (e)) {
+		struct thread *t = list_entry (e, struct thread, elem);
+		if (t->dl_abs_deadline < limit)
+			limit = t->dl_abs_deadline;
+	}
+	for (struct list_elem *e = list_begin (&limited_groups); e != list_end (&limited_groups);
+			e = list_next (e)) {
+		struct cpu_group *group = list_entry (e, struct cpu_group, elem);
+		if (group->throttled && group->period_start + group->period < limit)
+			limit = group->period_start + group->period;
+	}
+
+	for (int64_t tick = wheel_tick; tick < limit; tick++) {
+		int index = tick & WHEEL_ROOT_MASK;
+		if (index == 0 || !list_empty (&wheel_root[index]))
+			return tick;
+	}
+	return limit;
+}
+
+/* Puts sleeping thread T into the wheel slot that expires at
+   T->local_tick.  Interrupts must be off. */
+static void
+wheel_insert (struct thread *t) {
+	int64_t expires = t->local_tick;
+	int64_t delta = expires - wheel_tick;
+	struct list *slot;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (delta < 0)
+		slot = &wheel_root[wheel_tick & WHEEL_ROOT_MASK];
+	else if (delta < WHEEL_ROOT_SIZE)
+		slot = &wheel_root[expires & WHEEL_ROOT_MASK];
+	else {
+		slot = &wheel_overflow;
+		for (int level = 0; level < WHEEL_LEVELS; level++) {
+			int shift = WHEEL_ROOT_BITS + level * WHEEL_BITS;
+			if (delta < (1LL << (shift + WHEEL_BITS))) {
+				slot = &wheel[level][(expires >> shift) & WHEEL_MASK];
+				break;
+			}
 		}
 	}
+	list_push_back (slot, &t->elem);
 }
 
+/* Re-inserts every sleeper in SLOT relative to the current
+   wheel_tick, keeping their relative order. */
+static void
+wheel_requeue (struct list *slot) {
+	struct list pending;
+
+	list_init (&pending);
+	while (!list_empty (slot))
+		list_push_back (&pending, list_pop_front (slot));
+	while (!list_empty (&pending))
+		wheel_insert (list_entry (list_pop_front (&pending), struct thread, elem));
+}
+
+/* Cascades the current slot of outer wheel LEVEL down into the
+   lower levels.  Returns that slot's index; zero means the level
+   itself wrapped and the next level must be cascaded too. */
+static int
+wheel_cascade (int level) {
+	int shift = WHEEL_ROOT_BITS + level * WHEEL_BITS;
+	int index = (wheel_tick >> shift) & WHEEL_MASK;
+
+	wheel_requeue (&wheel[level][index]);
+	return index;
+}
 
 /* preempt the current thread if the ready list is not empty and the highest priority thread has higher priority than the current thread */
+/* In interrupt context, the preemption happens on interrupt return. */
 void 
 thread_try_preempt (void) {
-	if (list_empty (&ready_list)) {
+	struct thread *highest_ready_thread = ready_queue_highest ();
+	if (highest_ready_thread == NULL) {
 		return;
 	}
 
-	// NOTE: Must use list_begin, not list_front, because list_front is not safe when the list is empty.
-	struct thread* highest_ready_thread = list_entry (list_begin (&ready_list), struct thread, elem);
-	if (!intr_context () && thread_current ()->priority < highest_ready_thread->priority) {
-		thread_yield ();
+	if (thread_preempts (highest_ready_thread, thread_current ())) {
+		if (intr_context ())
+			intr_yield_on_return ();
+		else
+			thread_yield ();
 	}
 }
 
-
-/* Lab #1 - global tick 가져오기..*/
-int64_t
-get_global_tick (void) {
-	return global_tick;
+/* Returns true if ready thread A should run instead of running
+   thread B.  The deadline class beats every priority, and within
+   it the earlier absolute deadline wins. */
+static bool
+thread_preempts (const struct thread *a, const struct thread *b) {
+	if (a->dl_runtime != 0)
+		return b->dl_runtime == 0 || a->dl_abs_deadline < b->dl_abs_deadline;
+	if (b->dl_runtime != 0)
+		return false;
+	if (thread_cfs)
+		return b == idle_thread
+			|| a->vruntime + CFS_WAKEUP_GRANULARITY < b->vruntime;
+	return b->priority < a->priority;
 }
 
+
 /* Returns the name of the running thread. */
 const char *
 thread_name (void) {
@@ -459,6 +812,23 @@ thread_exit (void) {
 #ifdef USERPROG
 	process_exit ();
 #endif
+	palloc_flush_magazine ();
+
+	/* Leave our CPU group, freeing it if we were its last thread. */
+	struct thread *curr = thread_current ();
+	struct cpu_group *group = curr->cpu_group;
+	enum intr_level old_level = intr_disable ();
+	curr->cpu_group = &root_cpu_group;
+	if (group != &root_cpu_group && --group->ref_cnt == 0) {
+		if (group->quota >= 0)
+			list_remove (&group->elem);
+	} else
+		group = NULL;
+	intr_set_level (old_level);
+	free (group);
+
+	if (thread_schedstats)
+		print_sched_stats (curr);
 
 	/* Just set our status to dying and schedule another process.
 	   We will be destroyed during the call to schedule_tail(). */
@@ -466,8 +836,12 @@ thread_exit (void) {
 	
 	if (thread_mlfqs) {
 		// remove the thread from the mlfqs_list
+		if (decay_cursor == &thread_current()->mlfqs_elem)
+			decay_cursor = list_next(decay_cursor);
 		list_remove(&thread_current()->mlfqs_elem);
 	}
+	dl_total_bw -= dl_bandwidth (thread_current ());
+	list_remove (&curr->all_elem);
 
 	do_schedule (THREAD_DYING);
 	NOT_REACHED ();
@@ -484,9 +858,9 @@ thread_yield (void) {
 
 	old_level = intr_disable ();
 	if (curr != idle_thread) {
-		// list_push_back (&ready_list, &curr->elem);
-		list_insert_ordered(&ready_list, &curr->elem, (list_less_func *) &compare_thread_priority_desc, NULL);
+		ready_queue_push (curr);
 	}
+	curr->ready_since = timer_ns ();
 	do_schedule (THREAD_READY);
 	intr_set_level (old_level);
 }
@@ -499,16 +873,13 @@ thread_set_priority (int new_priority) {
 		return;
 	}
 	
-	// thread가 가지고 있는 lock을 기다리고 있는 다른 thread가 있다면 (=thread의 donors 리스트가 존재한다면)
-	// thread의 priorty는 새로운 priority로 바뀌는 것이 아닌 init_priority로 보관해두고, donor 리스트가 비워지면 priority를 init_priority로 바꾼다.
+	// thread가 가지고 있는 lock을 기다리고 있는 다른 thread가 있다면 (=held_locks에 donation이 남아 있다면)
+	// thread의 priorty는 새로운 priority로 바뀌는 것이 아닌 init_priority로 보관해두고, donation이 사라지면 priority를 init_priority로 바꾼다.
 	thread_current ()->init_priority = new_priority;
-	
-	// reorder the ready list for the new priority
-	if (!list_empty(&ready_list)) {
-		list_sort(&ready_list, (list_less_func *) &compare_thread_priority_desc, NULL);
-		thread_update_priority (); // 여기서 thread의 priority를 실제로 업데이트한다.
-		thread_try_preempt ();
-	}
+
+	// running thread는 ready queue에 없으므로 재정렬 없이 priority만 갱신하고 선점 여부를 확인한다.
+	thread_update_priority (); // 여기서 thread의 priority를 실제로 업데이트한다.
+	thread_try_preempt ();
 }
 
 /* Returns the current thread's priority. */
@@ -525,20 +896,30 @@ advanced_priority_calculation (struct thread *t) {
 		return;
 	}
 	//계산. nice는 int, but recent_cpu가 float이기에 값 맞춰주기.
-	t->priority = ((63 - t->nice*2)*(1<<14) + t->recent_cpu /(-4)) / (1<<14);
+	int priority = ((63 - t->nice*2)*(1<<14) + t->recent_cpu /(-4)) / (1<<14);
+
+	//PRI_MIN..PRI_MAX 범위로 제한 (ready queue index로 사용되므로)
+	if (priority < PRI_MIN)
+		priority = PRI_MIN;
+	else if (priority > PRI_MAX)
+		priority = PRI_MAX;
+
+	//ready 상태라면 새로운 priority의 queue로 옮겨준다.
+	thread_requeue (t, priority);
 }
 
-/* Lab 1 - advanced scheduler - recent_cpu calculation*/
+/* Lab 1 - advanced scheduler - recent_cpu calculation
+   Applies one second of decay with coefficient COEF, i.e.
+   2*load_avg / (2*load_avg + 1) in 17.14 fixed point. */
 void
-advanced_recent_cpu_calculation (struct thread *t) {
+advanced_recent_cpu_calculation (struct thread *t, int coef) {
 	//idle check
 	if (t == idle_thread) {
 		return;
 	}
 
 	//복잡한 계산식.
-	int L_a = load_avg*2;
-	t->recent_cpu = ((int64_t)( ((int64_t)(L_a)) * (1<<14) / (L_a+(1<<14)) ) ) * (t->recent_cpu)/(1<<14) + (t->nice)*(1<<14);
+	t->recent_cpu = ((int64_t) coef) * (t->recent_cpu)/(1<<14) + (t->nice)*(1<<14);
 }
 
 /* Lab 1 - advanced scheduler - load_avg calculation*/
@@ -547,10 +928,10 @@ advanced_load_avg_calculation (void) {
 	int ready_threads;
 	
 	if (thread_current() != idle_thread) {
-		ready_threads = list_size(&ready_list) + 1;
+		ready_threads = ready_cnt + 1;
 	}
 	else {
-		ready_threads = list_size(&ready_list);
+		ready_threads = ready_cnt;
 	}
 
 	load_avg = ( ((int64_t)( ( (int64_t)(59*(1<<14)) ) * (1<<14) / (60*(1<<14)) )) * load_avg / (1<<14) )
@@ -567,81 +948,134 @@ advanced_recent_cpu_increase (void) {
 	}
 }
 
-/* Lab 1 - advanced scheduler - update recent_cpu*/
+/* Lab 1 - advanced scheduler - update recent_cpu
+   Starts a new decay epoch using the current load_avg.  Only the
+   running thread is decayed right away; the others catch up
+   lazily through advanced_decay_catch_up(). */
 void
 advanced_recent_cpu_update (void) {
-	struct list_elem *e;
-	struct thread *t;
+	//load_avg로부터 이번 epoch의 계수를 계산해서 저장.
+	int L_a = load_avg*2;
+	decay_epoch++;
+	decay_coef[decay_epoch % DECAY_HISTORY] = (int64_t)(L_a) * (1<<14) / (L_a+(1<<14));
 
-	//list 시작부에서 끝까지 체크.
-	for (e = list_begin(&mlfqs_list); e != list_end(&mlfqs_list); e = list_next(e)) {
-		//list_entry 매크로를 사용해서 mlfqs_elem에서 해당하는 thread를 가져온다.
-		t = list_entry(e, struct thread, mlfqs_elem);
-		//해당 값에 대해 recent_cpu를 계산한다.
-		advanced_recent_cpu_calculation(t);
-	}
+	//현재 쓰레드는 바로 반영하고, 나머지는 cursor가 조금씩 따라잡는다.
+	advanced_decay_catch_up (thread_current ());
+	decay_cursor = list_begin (&mlfqs_list);
 }
 
-/* Lab 1 - advanced scheduler - priority update*/
+/* Lab 1 - advanced scheduler - priority update
+   Called every time slice.  Only the running thread's recent_cpu
+   has changed since its priority was last computed, so it is the
+   only one recomputed. */
 void
 advanced_priority_update (void) {
-	struct list_elem *e;
-	struct thread *t;
+	advanced_priority_calculation (thread_current ());
+}
 
-	//mlfq 리스트의 인스턴스들을 처음부터 끝까지 실행시킨다.
-	for (e = list_begin(&mlfqs_list); e != list_end(&mlfqs_list); e = list_next(e)) {
-		// list_entry 매크로를 사용해서 mlfqs_elem에서 해당하는 thread를 가져온다.
-		t = list_entry(e, struct thread, mlfqs_elem);
-		//해당 값에 대해 priority를 계산한다.
-		advanced_priority_calculation(t);
+/* Lab 1 - advanced scheduler - incremental decay
+   Called every tick.  Catches up to DECAY_BATCH threads from the
+   cursor on the decay epochs they missed. */
+void
+advanced_decay_step (void) {
+	for (int i = 0; i < DECAY_BATCH; i++) {
+		if (decay_cursor == NULL || decay_cursor == list_end (&mlfqs_list))
+			return;
+
+		struct thread *t = list_entry (decay_cursor, struct thread, mlfqs_elem);
+		decay_cursor = list_next (decay_cursor);
+		advanced_decay_catch_up (t);
 	}
 }
 
+/* Applies the decay epochs T has missed, then recomputes its
+   priority.  If T missed more than DECAY_HISTORY epochs, only the
+   most recent DECAY_HISTORY are applied; by then the older ones
+   have decayed away almost entirely. */
+static void
+advanced_decay_catch_up (struct thread *t) {
+	enum intr_level old_level;
+
+	if (t == idle_thread || t->decay_epoch == decay_epoch)
+		return;
+
+	old_level = intr_disable ();
+	if (decay_epoch - t->decay_epoch > DECAY_HISTORY)
+		t->decay_epoch = decay_epoch - DECAY_HISTORY;
+	while (t->decay_epoch < decay_epoch) {
+		t->decay_epoch++;
+		advanced_recent_cpu_calculation (t, decay_coef[t->decay_epoch % DECAY_HISTORY]);
+	}
+	advanced_priority_calculation (t);
+	intr_set_level (old_level);
+}
+
 /** Donate the priority to the holder of the lock.
  * This function is called when the current thread attempts to acquire a lock.
- * The current thread donates its priority to the holder of the lock.
+ * The current thread's priority becomes the donation of the lock it waits for,
+ * which raises the holder, and the raise follows the chain of waiting_lock
+ * links for as long as it changes anything.  Each step re-keys one lock in its
+ * holder's held_locks and one thread in its queue, so it takes O(log n) time,
+ * and there is no limit on the length of the chain.
+ * Interrupts must be off.
  */
 void
 thread_donate_priority (void) {
-	struct thread *current_thread = thread_current ();
-	int new_priority = current_thread->priority; // donate할 priority
-	
-	struct thread *holder;
-	int NESTED_DEPTH = 8; //NOTE: nested depth를 지정해주지 않고 그냥 for문으로 waiting_lock이 null이 될 때까지 돌리면 kernel panic
-    for (int i = 0; i < NESTED_DEPTH; i++) {
-        if (current_thread->waiting_lock == NULL) {
-            return;
-		}
+	struct thread *donor = thread_current ();
 
-		holder = current_thread->waiting_lock->holder; // lock을 가지고 있는 thread
-		holder->priority = new_priority; // holder의 priority를 donate할 priority로 업데이트
-		current_thread = holder; // current_thread를 holder로 변경
-    }
+	thread_donate_to_lock (donor->waiting_lock, donor->priority);
 }
 
-/** Update the priority of the current thread based on the donors list.
+/** Donate PRIORITY to the holder of LOCK, if any, and on along the chain
+ * as thread_donate_priority() does.  A holder that is a writer waiting for
+ * the readers of an rwlock to leave passes the donation on to each of them.
+ * Interrupts must be off.
+ */
+void
+thread_donate_to_lock (struct lock *lock, int priority) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while (lock != NULL && lock->holder != NULL && lock->priority < priority) {
+		struct thread *holder = lock->holder; // lock을 가지고 있는 thread
+
+		// lock의 donation을 올리고 holder의 held_locks에서 위치를 갱신
+		rb_remove (&holder->held_locks, &lock->holder_elem);
+		lock->priority = priority;
+		rb_insert (&holder->held_locks, &lock->holder_elem);
+
+		// holder의 priority가 이미 충분히 높으면 더 이상 전파할 필요가 없다.
+		if (holder->priority >= priority)
+			break;
+		thread_requeue (holder, priority);
+
+		lock = holder->waiting_lock;
+		if (lock == NULL && holder->draining_rwlock != NULL)
+			rwlock_donate (holder->draining_rwlock, priority);
+	}
+}
+
+/** Update the priority of the current thread based on the locks it holds.
  * This function is called in the following cases:
- * 1. When the current thread releases the lock it holds.
+ * 1. When the current thread acquires or releases a lock.
  * 2. When the current thread's priority is set to a new value.
+ * The effective priority is the higher of init_priority and the largest
+ * donation among held locks, which is the first node of held_locks.
  */
 void
 thread_update_priority (void) {
 	struct thread* current_thread = thread_current ();
-
-	// thread가 donors 리스트를 가지고 있지 않다면(=자신이 가지고 있는 lock을 기다리는 다른 thread가 없다면) init_priority로 돌아감
-	if (list_empty(&(current_thread->donors))) {
-		current_thread->priority = current_thread->init_priority;
-		return;
+	struct rb_node *top = rb_first (&current_thread->held_locks);
+	int priority = current_thread->init_priority;
+
+	// multiple donation case, 여러 lock 중 가장 큰 donation과 본인의 최초 priority 중 더 높은 값
+	if (top != NULL) {
+		int donated = rb_entry (top, struct lock, holder_elem)->priority;
+		if (donated > priority)
+			priority = donated;
 	}
 
-	// donors는 lock_acquire() 에서 정렬되었으므로, 가장 높은 priority를 가진 thread는 가장 앞의 thread
-	struct thread* highest_priority_thread = list_entry(list_front(&current_thread->donors), struct thread, donor_elem);
-
-	// multiple donation case, 물려있는 여러 개의 lock 중 하나가 release되면, 그 lock의 donor을 제외한 나머지 donor들 중 가장 높은 priority를 가져와서,
-	// 본인의 최초 priority와 가장 높은 donor priority를 비교하여 더 높은 priority로 업데이트
-	if (highest_priority_thread->priority > current_thread->init_priority) {
-		current_thread->priority = highest_priority_thread->priority;
-	}
+	// cond_wait() 중이면 wait queue에 들어 있으므로 thread_requeue로 갱신한다.
+	thread_requeue (current_thread, priority);
 }
 
 /* Sets the current thread's nice value to NICE. */
@@ -653,8 +1087,9 @@ thread_set_nice (int nice UNUSED) {
 	//현재 쓰레드 nice 설정
 	thread_current()->nice = nice;
 
-	//우선순위 설정
-	advanced_priority_calculation(thread_current());
+	//우선순위 설정 (CFS는 priority 대신 nice에 따른 weight를 사용한다)
+	if (!thread_cfs)
+		advanced_priority_calculation(thread_current());
 
 	//우선순위에 따라 선점 시도
 	thread_try_preempt();
@@ -748,6 +1183,10 @@ idle (void *idle_started_ UNUSED) {
 		intr_disable ();
 		thread_block ();
 
+		/* With "-nohz", stop the periodic tick until the next
+		   sleeper is due.  Nothing else is runnable right now. */
+		timer_nohz_enter ();
+
 		/* Re-enable interrupts and wait for the next one.
 
 		   The `sti' instruction disables interrupts until the
@@ -761,6 +1200,8 @@ idle (void *idle_started_ UNUSED) {
 		   See [IA32-v2a] "HLT", [IA32-v2b] "STI", and [IA32-v3a]
 		   7.11.1 "HLT Instruction". */
 		asm volatile ("sti; hlt" : : : "memory");
+
+		timer_nohz_exit ();
 	}
 }
 
@@ -790,12 +1231,18 @@ init_thread (struct thread *t, const char *name, int priority) {
 	t->priority = priority;
 	t->init_priority = priority;
 	t->waiting_lock = NULL;
-	list_init(&(t->donors));
+	rb_init (&t->held_locks, compare_lock_priority_desc, NULL);
+	t->draining_rwlock = NULL;
+	for (int i = 0; i < RWLOCK_HOLD_MAX; i++) {
+		lock_init (&t->read_holds[i].lock);
+		t->read_holds[i].rw = NULL;
+	}
 	t->magic = THREAD_MAGIC;
 	
 	//초기값 설정하기
 	t->nice = 0;
 	t->recent_cpu = 0;
+	t->cpu_group = &root_cpu_group;
 
 #ifdef USERPROG
 	// t->exit_status = 0;
@@ -813,10 +1260,423 @@ init_thread (struct thread *t, const char *name, int priority) {
    idle_thread. */
 static struct thread *
 next_thread_to_run (void) {
-	if (list_empty (&ready_list))
-		return idle_thread;
+	struct thread *next;
+
+	for (;;) {
+		next = ready_queue_highest ();
+		if (next == NULL)
+			return idle_thread;
+
+		/* Under MLFQS, a thread that missed a decay epoch while
+		   waiting may belong in a different queue.  Catching it up
+		   requeues it, so look again until the head is current. */
+		if (thread_mlfqs && next->decay_epoch != decay_epoch)
+			advanced_decay_catch_up (next);
+
+		/* A thread whose group was throttled after it was queued
+		   is parked now; requeueing it does that. */
+		else if (next->cpu_group->throttled) {
+			ready_queue_remove (next);
+			ready_queue_push (next);
+		} else
+			break;
+	}
+
+	ready_queue_remove (next);
+	return next;
+}
+
+/* Appends T to the tail of the ready queue for its priority, or
+   files it by deadline if T is in the deadline class or by
+   vruntime under CFS.  If T's CPU group is throttled, parks T in
+   the group instead.  Interrupts must be off. */
+static void
+ready_queue_push (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (PRI_MIN <= t->priority && t->priority <= PRI_MAX);
+
+	if (t->cpu_group->throttled) {
+		list_push_back (&t->cpu_group->parked, &t->elem);
+		t->cpu_parked = true;
+		return;
+	}
+	if (t->dl_runtime != 0) {
+		if (t->dl_throttled)
+			list_push_back (&dl_throttled, &t->elem);
+		else {
+			list_insert_ordered (&dl_queue, &t->elem,
+					compare_dl_deadline_asc, NULL);
+			ready_cnt++;
+		}
+		return;
+	}
+	if (thread_cfs) {
+		rb_insert (&cfs_queue, &t->cfs_node);
+		cfs_load += cfs_weight (t);
+		ready_cnt++;
+		return;
+	}
+
+	list_push_back (&ready_queues[t->priority], &t->elem);
+	ready_mask |= 1ULL << t->priority;
+	ready_cnt++;
+}
+
+/* Removes T from the ready queue for its priority.
+   Interrupts must be off. */
+static void
+ready_queue_remove (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (t->status == THREAD_READY);
+
+	if (t->cpu_parked) {
+		list_remove (&t->elem);
+		t->cpu_parked = false;
+		return;
+	}
+	if (t->dl_runtime != 0) {
+		list_remove (&t->elem);
+		if (!t->dl_throttled)
+			ready_cnt--;
+		return;
+	}
+	if (thread_cfs) {
+		rb_remove (&cfs_queue, &t->cfs_node);
+		cfs_load -= cfs_weight (t);
+		ready_cnt--;
+		return;
+	}
+
+	list_remove (&t->elem);
+	if (list_empty (&ready_queues[t->priority]))
+		ready_mask &= ~(1ULL << t->priority);
+	ready_cnt--;
+}
+
+/* Returns the EDF thread with the earliest deadline or else the
+   CFS thread with the least vruntime or the first thread of the
+   highest non-empty ready queue, without removing it, or a null
+   pointer if no thread is ready. */
+static struct thread *
+ready_queue_highest (void) {
+	if (!list_empty (&dl_queue))
+		return list_entry (list_front (&dl_queue), struct thread, elem);
+	if (thread_cfs) {
+		struct rb_node *leftmost = rb_first (&cfs_queue);
+		return leftmost != NULL ? rb_entry (leftmost, struct thread, cfs_node) : NULL;
+	}
+	if (ready_mask == 0)
+		return NULL;
+
+	int priority = 63 - __builtin_clzll (ready_mask);
+	return list_entry (list_front (&ready_queues[priority]), struct thread, elem);
+}
+
+/* Sets T's effective priority to PRIORITY.  If T is waiting in
+   the ready queue, moves it to the tail of the queue for its new
+   priority so that the queues never need re-sorting.  If T is in
+   a wait queue, re-keys it there too. */
+static void
+thread_requeue (struct thread *t, int priority) {
+	enum intr_level old_level;
+
+	if (t->priority == priority)
+		return;
+
+	old_level = intr_disable ();
+	if (t->status == THREAD_READY)
+		ready_queue_remove (t);
+	if (t->wait_queue != NULL)
+		wait_queue_set_priority (t, priority);
 	else
-		return list_entry (list_pop_front (&ready_list), struct thread, elem);
+		t->priority = priority;
+	if (t->status == THREAD_READY)
+		ready_queue_push (t);
+	intr_set_level (old_level);
+}
+
+/* Orders EDF threads by absolute deadline, earliest first. */
+static bool
+compare_dl_deadline_asc (const struct list_elem *a_,
+		const struct list_elem *b_, void *aux UNUSED) {
+	const struct thread *a = list_entry (a_, struct thread, elem);
+	const struct thread *b = list_entry (b_, struct thread, elem);
+
+	return a->dl_abs_deadline < b->dl_abs_deadline;
+}
+
+/* Returns the share of the CPU reserved by T, in units of
+   1/DL_BW_UNIT. */
+static int64_t
+dl_bandwidth (const struct thread *t) {
+	if (t->dl_runtime == 0)
+		return 0;
+	return t->dl_runtime * DL_BW_UNIT / t->dl_period;
+}
+
+/* Moves the running thread into the deadline class with RUNTIME
+   ticks of budget every PERIOD ticks, to be used within DEADLINE
+   ticks of the start of each period, or back to the priority
+   classes if RUNTIME is 0.  Requires 0 < RUNTIME <= DEADLINE <=
+   PERIOD.  Returns false, changing nothing, if the parameters are
+   invalid or the new reservation would push the total beyond the
+   admission limit. */
+bool
+thread_set_deadline (int64_t runtime, int64_t deadline, int64_t period) {
+	struct thread *curr = thread_current ();
+	enum intr_level old_level;
+	int64_t bw = 0;
+
+	if (runtime != 0) {
+		if (runtime < 0 || runtime > deadline || deadline > period)
+			return false;
+		bw = runtime * DL_BW_UNIT / period;
+	}
+
+	old_level = intr_disable ();
+	if (dl_total_bw - dl_bandwidth (curr) + bw > DL_BW_LIMIT) {
+		intr_set_level (old_level);
+		return false;
+	}
+	dl_total_bw += bw - dl_bandwidth (curr);
+	curr->dl_runtime = runtime;
+	curr->dl_deadline = deadline;
+	curr->dl_period = period;
+	curr->dl_abs_deadline = timer_ticks () + deadline;
+	curr->dl_budget = runtime;
+	curr->dl_throttled = false;
+	intr_set_level (old_level);
+
+	/* Leaving the class, or taking a later deadline, may let
+	   another thread run first. */
+	thread_try_preempt ();
+	return true;
+}
+
+/* Constant bandwidth server wake-up rule.  A waking EDF thread
+   keeps its current deadline only if the budget it has left can
+   be spent before that deadline without exceeding its reserved
+   bandwidth; otherwise it starts a fresh period from now.
+   Interrupts must be off. */
+static void
+dl_wakeup (struct thread *t) {
+	int64_t now = timer_ticks ();
+
+	if (t->dl_throttled)
+		return;
+	if (t->dl_abs_deadline <= now
+			|| t->dl_budget * t->dl_period > (t->dl_abs_deadline - now) * t->dl_runtime) {
+		t->dl_abs_deadline = now + t->dl_deadline;
+		t->dl_budget = t->dl_runtime;
+	}
+}
+
+/* Refills every throttled EDF thread whose deadline has passed,
+   postponing its deadline by one period, and asks for preemption
+   if one of them should run before the current thread.  Called
+   from the timer interrupt. */
+static void
+dl_replenish (void) {
+	int64_t now = timer_ticks ();
+	struct list_elem *e = list_begin (&dl_throttled);
+
+	while (e != list_end (&dl_throttled)) {
+		struct thread *t = list_entry (e, struct thread, elem);
+
+		e = list_next (e);
+		if (t->dl_abs_deadline > now)
+			continue;
+
+		list_remove (&t->elem);
+		t->dl_throttled = false;
+		t->dl_abs_deadline += t->dl_period;
+		if (t->dl_abs_deadline <= now)
+			t->dl_abs_deadline = now + t->dl_deadline;
+		t->dl_budget = t->dl_runtime;
+		ready_queue_push (t);
+		if (thread_preempts (t, thread_current ()))
+			intr_yield_on_return ();
+	}
+}
+
+/* Limits the running thread's CPU group to QUOTA ticks of CPU
+   time every PERIOD ticks.  A thread still in the unlimited root
+   group first gets a group of its own, which the threads it
+   creates from then on will share; there a QUOTA of -1 does
+   nothing.  A group that already has a limit may only have it
+   tightened, to no more than its current share of the CPU, so
+   that no thread in the group can lift a limit set on it.  The
+   group keeps its usage for the current period, and is throttled
+   at once if that already exceeds the new quota.  Returns false
+   if the arguments are invalid, the limit would be loosened, or
+   memory runs out. */
+bool
+thread_set_cpu_max (int64_t quota, int64_t period) {
+	struct thread *curr = thread_current ();
+	struct cpu_group *group = curr->cpu_group;
+	enum intr_level old_level;
+
+	if (period <= 0 || quota == 0 || quota < -1)
+		return false;
+
+	if (group == &root_cpu_group) {
+		if (quota < 0)
+			return true;
+		group = malloc (sizeof *group);
+		if (group == NULL)
+			return false;
+		group->quota = -1;
+		group->usage = 0;
+		group->throttled = false;
+		group->throttled_ticks = 0;
+		list_init (&group->parked);
+		group->ref_cnt = 1;
+	} else if (quota < 0 || quota * group->period > group->quota * period)
+		return false;
+
+	old_level = intr_disable ();
+	if (group->quota < 0) {
+		list_push_back (&limited_groups, &group->elem);
+		group->period_start = timer_ticks ();
+	}
+	curr->cpu_group = group;
+	group->quota = quota;
+	group->period = period;
+	if (group->usage >= quota && !group->throttled) {
+		group->throttled = true;
+		group->throttled_since = timer_ticks ();
+	}
+	intr_set_level (old_level);
+
+	if (group->throttled)
+		thread_yield ();
+	return true;
+}
+
+/* Copies the running thread's scheduling statistics into STATS,
+   which must be in kernel memory: the copy is made with
+   interrupts off. */
+void
+thread_get_sched_stats (struct sched_stats *stats) {
+	enum intr_level old_level = intr_disable ();
+	*stats = thread_current ()->stats;
+	intr_set_level (old_level);
+}
+
+/* Returns the number of ticks the running thread's CPU group has
+   spent throttled, including any throttling still in progress. */
+int64_t
+thread_get_cpu_throttled (void) {
+	struct cpu_group *group = thread_current ()->cpu_group;
+	enum intr_level old_level = intr_disable ();
+	int64_t ticks = group->throttled_ticks;
+
+	if (group->throttled)
+		ticks += timer_ticks () - group->throttled_since;
+	intr_set_level (old_level);
+	return ticks;
+}
+
+/* Starts a new period for every limited group whose period has
+   elapsed, releasing the threads it parked.  Called from the
+   timer interrupt. */
+static void
+cpu_group_refill (void) {
+	int64_t now = timer_ticks ();
+
+	for (struct list_elem *e = list_begin (&limited_groups); e != list_end (&limited_groups);
+			e = list_next (e)) {
+		struct cpu_group *group = list_entry (e, struct cpu_group, elem);
+
+		if (now - group->period_start < group->period)
+			continue;
+		group->period_start = now;
+		group->usage = 0;
+		if (group->throttled)
+			cpu_group_unthrottle (group);
+	}
+}
+
+/* Lifts GROUP's throttling and returns its parked threads to the
+   run queue, asking for preemption if one of them should run
+   first.  Interrupts must be off. */
+static void
+cpu_group_unthrottle (struct cpu_group *group) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	group->throttled = false;
+	group->throttled_ticks += timer_ticks () - group->throttled_since;
+	while (!list_empty (&group->parked)) {
+		struct thread *t = list_entry (list_pop_front (&group->parked), struct thread, elem);
+
+		t->cpu_parked = false;
+		ready_queue_push (t);
+		if (intr_context () && thread_preempts (t, thread_current ()))
+			intr_yield_on_return ();
+	}
+}
+
+/* Orders held locks by donated priority, highest first. */
+static bool
+compare_lock_priority_desc (const struct rb_node *a,
+		const struct rb_node *b, void *aux UNUSED) {
+	return rb_entry (a, struct lock, holder_elem)->priority
+		> rb_entry (b, struct lock, holder_elem)->priority;
+}
+
+/* Orders CFS threads by vruntime, least first. */
+static bool
+compare_vruntime_less (const struct rb_node *a_,
+		const struct rb_node *b_, void *aux UNUSED) {
+	const struct thread *a = rb_entry (a_, struct thread, cfs_node);
+	const struct thread *b = rb_entry (b_, struct thread, cfs_node);
+
+	return a->vruntime < b->vruntime;
+}
+
+/* Returns T's CFS weight for its nice value. */
+static int
+cfs_weight (const struct thread *t) {
+	int nice = t->nice;
+
+	if (nice < NICE_MIN)
+		nice = NICE_MIN;
+	else if (nice > NICE_MAX)
+		nice = NICE_MAX;
+	return cfs_nice_weight[nice - NICE_MIN];
+}
+
+/* Returns the number of ticks running thread T may run before it
+   is preempted: its weighted share of a period that covers every
+   runnable thread, stretched when there are too many of them to
+   give each CFS_MIN_GRANULARITY within CFS_LATENCY. */
+static unsigned
+cfs_slice (const struct thread *t) {
+	int64_t nr_running = ready_cnt + 1;
+	int64_t period = CFS_LATENCY;
+	int64_t slice;
+
+	if (nr_running * CFS_MIN_GRANULARITY > period)
+		period = nr_running * CFS_MIN_GRANULARITY;
+	slice = period * cfs_weight (t) / (cfs_load + cfs_weight (t));
+	return slice > CFS_MIN_GRANULARITY ? slice : CFS_MIN_GRANULARITY;
+}
+
+/* Advances min_vruntime to the least vruntime among the running
+   thread and the ready threads, never moving it backward. */
+static void
+cfs_update_min_vruntime (void) {
+	struct thread *curr = thread_current ();
+	struct rb_node *leftmost = rb_first (&cfs_queue);
+	int64_t vruntime = curr->vruntime;
+
+	if (leftmost != NULL) {
+		struct thread *t = rb_entry (leftmost, struct thread, cfs_node);
+		if (t->vruntime < vruntime)
+			vruntime = t->vruntime;
+	}
+	if (vruntime > min_vruntime)
+		min_vruntime = vruntime;
 }
 
 /* Use iretq to launch the thread */
@@ -859,61 +1719,13 @@ do_iret (struct intr_frame *tf) {
    added at the end of the function. */
 static void
 thread_launch (struct thread *th) {
-	uint64_t tf_cur = (uint64_t) &running_thread ()->tf;
-	uint64_t tf = (uint64_t) &th->tf;
 	ASSERT (intr_get_level () == INTR_OFF);
 
-	/* The main switching logic.
-	 * We first restore the whole execution context into the intr_frame
-	 * and then switching to the next thread by calling do_iret.
-	 * Note that, we SHOULD NOT use any stack from here
-	 * until switching is done. */
-	__asm __volatile (
-			/* Store registers that will be used. */
-			"push %%rax\n"
-			"push %%rbx\n"
-			"push %%rcx\n"
-			/* Fetch input once */
-			"movq %0, %%rax\n"
-			"movq %1, %%rcx\n"
-			"movq %%r15, 0(%%rax)\n"
-			"movq %%r14, 8(%%rax)\n"
-			"movq %%r13, 16(%%rax)\n"
-			"movq %%r12, 24(%%rax)\n"
-			"movq %%r11, 32(%%rax)\n"
-			"movq %%r10, 40(%%rax)\n"
-			"movq %%r9, 48(%%rax)\n"
-			"movq %%r8, 56(%%rax)\n"
-			"movq %%rsi, 64(%%rax)\n"
-			"movq %%rdi, 72(%%rax)\n"
-			"movq %%rbp, 80(%%rax)\n"
-			"movq %%rdx, 88(%%rax)\n"
-			"pop %%rbx\n"              // Saved rcx
-			"movq %%rbx, 96(%%rax)\n"
-			"pop %%rbx\n"              // Saved rbx
-			"movq %%rbx, 104(%%rax)\n"
-			"pop %%rbx\n"              // Saved rax
-			"movq %%rbx, 112(%%rax)\n"
-			"addq $120, %%rax\n"
-			"movw %%es, (%%rax)\n"
-			"movw %%ds, 8(%%rax)\n"
-			"addq $32, %%rax\n"
-			"call __next\n"         // read the current rip.
-			"__next:\n"
-			"pop %%rbx\n"
-			"addq $(out_iret -  __next), %%rbx\n"
-			"movq %%rbx, 0(%%rax)\n" // rip
-			"movw %%cs, 8(%%rax)\n"  // cs
-			"pushfq\n"
-			"popq %%rbx\n"
-			"mov %%rbx, 16(%%rax)\n" // eflags
-			"mov %%rsp, 24(%%rax)\n" // rsp
-			"movw %%ss, 32(%%rax)\n"
-			"mov %%rcx, %%rdi\n"
-			"call do_iret\n"
-			"out_iret:\n"
-			: : "g"(tf_cur), "g" (tf) : "memory"
-			);
+	/* Every switch is a plain function call from here, so only the
+	 * callee-saved registers are kept, on the current stack.  A
+	 * thread that has never run (switch_rsp == 0) is started from
+	 * its intr_frame with iretq instead. */
+	switch_threads (&running_thread ()->switch_rsp, th->switch_rsp, &th->tf);
 }
 
 /* Schedules a new process. At entry, interrupts must be off.
@@ -927,7 +1739,7 @@ do_schedule(int status) {
 	while (!list_empty (&destruction_req)) {
 		struct thread *victim =
 			list_entry (list_pop_front (&destruction_req), struct thread, elem);
-		palloc_free_page(victim);
+		thread_page_free (victim);
 	}
 	thread_current ()->status = status;
 	schedule ();
@@ -948,6 +1760,15 @@ schedule (void) {
 	ASSERT (intr_get_level () == INTR_OFF);
 	ASSERT (curr->status != THREAD_RUNNING);
 	ASSERT (is_thread (next));
+
+	/* Update scheduling statistics. */
+	if (curr->status == THREAD_BLOCKED)
+		curr->stats.voluntary_switches++;
+	else if (curr->status == THREAD_READY)
+		curr->stats.involuntary_switches++;
+	if (next != idle_thread)
+		next->stats.run_delay += timer_ns () - next->ready_since;
+
 	/* Mark us as running.  다음 쓰레드의 상태를 실행으로 변경.*/
 	next->status = THREAD_RUNNING;
 
@@ -978,6 +1799,39 @@ schedule (void) {
 	}
 }
 
+/* Returns a page for a new thread, reusing a dead thread's page
+   if one is cached, or a null pointer if memory is exhausted.
+   The page is not zeroed; init_thread() clears what it needs. */
+static struct thread *
+thread_page_alloc (void) {
+	struct thread *t = NULL;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if (!list_empty (&thread_cache)) {
+		t = list_entry (list_pop_front (&thread_cache), struct thread, elem);
+		thread_cache_cnt--;
+	}
+	intr_set_level (old_level);
+
+	return t != NULL ? t : palloc_get_page (0);
+}
+
+/* Releases the page of dead thread T, keeping it for reuse if the
+   cache has room.  Interrupts must be off. */
+static void
+thread_page_free (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	/* Make any use of the dead thread fail is_thread(). */
+	t->magic = 0;
+	if (thread_cache_cnt < THREAD_CACHE_MAX) {
+		list_push_front (&thread_cache, &t->elem);
+		thread_cache_cnt++;
+	} else
+		palloc_free_page (t);
+}
+
 /* Returns a tid to use for a new thread. */
 static tid_t
 allocate_tid (void) {
@@ -0,0 +1,97 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* A work queue and the worker thread that drains it. */
+struct workqueue {
+	const char *name;           /* Worker thread name. */
+	int priority;               /* Worker priority. */
+	int nice;                   /* Worker nice value, for -mlfqs and -cfs. */
+	struct list works;          /* Pending work, oldest first. */
+	struct semaphore ready;     /* Number of pending works. */
+};
+
+static struct workqueue workqueues[WORK_PRIORITY_CNT] = {
+	[WORK_HIGH] = { "kworker-high", PRI_MAX, NICE_MIN },
+	[WORK_DEFAULT] = { "kworker", PRI_DEFAULT, 0 },
+	[WORK_LOW] = { "kworker-low", PRI_MIN, NICE_MAX },
+};
+
+static thread_func worker;
+
+/* Starts a worker thread for each work queue. */
+void
+workqueue_init (void) {
+	for (int i = 0; i < WORK_PRIORITY_CNT; i++) {
+		struct workqueue *wq = &workqueues[i];
+
+		list_init (&wq->works);
+		sema_init (&wq->ready, 0);
+		if (thread_create (wq->name, wq->priority, worker, wq) == TID_ERROR)
+			PANIC ("workqueue_init: cannot start %s", wq->name);
+	}
+}
+
+/* Initializes WORK to call FUNC with AUX when it runs. */
+void
+work_init (struct work *work, work_func *func, void *aux) {
+	ASSERT (work != NULL);
+	ASSERT (func != NULL);
+
+	work->func = func;
+	work->aux = aux;
+	work->pending = false;
+}
+
+/* Queues WORK to run in the worker of PRIORITY, and returns true,
+   or returns false if WORK is already pending.  WORK may be
+   queued again as soon as it starts to run.  May be called from
+   an interrupt handler. */
+bool
+work_queue (enum work_priority priority, struct work *work) {
+	struct workqueue *wq;
+	enum intr_level old_level;
+
+	ASSERT (priority < WORK_PRIORITY_CNT);
+	ASSERT (work != NULL);
+
+	wq = &workqueues[priority];
+	old_level = intr_disable ();
+	if (work->pending) {
+		intr_set_level (old_level);
+		return false;
+	}
+	work->pending = true;
+	list_push_back (&wq->works, &work->elem);
+	intr_set_level (old_level);
+
+	sema_up (&wq->ready);
+	return true;
+}
+
+/* Worker thread.  Runs the work queued on WQ, oldest first. */
+static void
+worker (void *wq_) {
+	struct workqueue *wq = wq_;
+
+	/* Under -mlfqs and -cfs, nice rather than priority sets how
+	   much CPU time the worker gets. */
+	if (thread_mlfqs || thread_cfs)
+		thread_set_nice (wq->nice);
+
+	for (;;) {
+		enum intr_level old_level;
+		struct work *work;
+
+		sema_down (&wq->ready);
+		old_level = intr_disable ();
+		work = list_entry (list_pop_front (&wq->works), struct work, elem);
+		work->pending = false;
+		intr_set_level (old_level);
+
+		work->func (work->aux);
+	}
+}
@@ -1,17 +1,54 @@
 #include "userprog/exception.h"
 #include <inttypes.h>
+#include <round.h>
 #include <stdio.h>
+#include <string.h>
 #include "userprog/gdt.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/thread.h"
 #include "userprog/syscall.h"
 #include "intrinsic.h"
 
+/* Control register bits used for lazy FPU switching. */
+#define CR0_MP (1 << 1)         /* Monitor coprocessor: WAIT honors TS. */
+#define CR0_EM (1 << 2)         /* Emulate FPU: must be clear for SSE. */
+#define CR0_TS (1 << 3)         /* Task switched: next FPU use raises #NM. */
+#define CR4_OSFXSR (1 << 9)     /* OS supports FXSAVE/FXRSTOR and SSE. */
+#define CR4_OSXMMEXCPT (1 << 10) /* OS handles #XF. */
+
+/* FXSAVE area size and required alignment. */
+#define FPU_AREA_SIZE 512
+#define FPU_AREA_ALIGN 16
+
+/* Offsets of the x87 control word and MXCSR in an FXSAVE area,
+   and the MXCSR bits that are sticky exception flags rather than
+   control bits. */
+#define FXSAVE_FCW 0
+#define FXSAVE_MXCSR 24
+#define MXCSR_FLAGS 0x3f
+
+/* FXSAVE image of the initial FPU state: every register zero,
+   x87 exceptions masked with extended precision (FCW 0x37f) and
+   SIMD exceptions masked (MXCSR 0x1f80).  A thread's first FPU
+   use loads this, so it sees nothing left by an earlier owner. */
+static uint8_t fpu_init_state[FPU_AREA_SIZE]
+	__attribute__ ((aligned (FPU_AREA_ALIGN)));
+
 /* Number of page faults processed. */
 static long long page_fault_cnt;
 
+/* Number of #NM faults that loaded a thread's FPU state. */
+static long long fpu_switch_cnt;
+
+/* Thread whose registers are currently loaded in the FPU, or
+   NULL if none.  Everyone else runs with CR0.TS set. */
+static struct thread *fpu_owner;
+
 static void kill (struct intr_frame *);
 static void page_fault (struct intr_frame *);
+static void device_not_available (struct intr_frame *);
+static void fpu_init (void);
 
 /* Registers handlers for interrupts that can be caused by user
    programs.
@@ -46,7 +83,7 @@ exception_init (void) {
 	intr_register_int (0, 0, INTR_ON, kill, "#DE Divide Error");
 	intr_register_int (1, 0, INTR_ON, kill, "#DB Debug Exception");
 	intr_register_int (6, 0, INTR_ON, kill, "#UD Invalid Opcode Exception");
-	intr_register_int (7, 0, INTR_ON, kill,
+	intr_register_int (7, 0, INTR_ON, device_not_available,
 			"#NM Device Not Available Exception");
 	intr_register_int (11, 0, INTR_ON, kill, "#NP Segment Not Present");
 	intr_register_int (12, 0, INTR_ON, kill, "#SS Stack Fault Exception");
@@ -59,12 +96,104 @@ exception_init (void) {
 	   We need to disable interrupts for page faults because the
 	   fault address is stored in CR2 and needs to be preserved. */
 	intr_register_int (14, 0, INTR_OFF, page_fault, "#PF Page-Fault Exception");
+
+	fpu_init ();
 }
 
 /* Prints exception statistics. */
 void
 exception_print_stats (void) {
 	printf ("Exception: %lld page faults\n", page_fault_cnt);
+	printf ("FPU: %lld lazy switches\n", fpu_switch_cnt);
+}
+
+/* Enables the FPU and SSE for user programs.  CR0.TS starts out
+   set, so the first FPU instruction of any thread raises #NM. */
+static void
+fpu_init (void) {
+	lcr4 (rcr4 () | CR4_OSFXSR | CR4_OSXMMEXCPT);
+	lcr0 ((rcr0 () & ~(CR0_EM | CR0_TS)) | CR0_MP);
+	__asm __volatile ("fninit");
+	lcr0 (rcr0 () | CR0_TS);
+
+	*(uint16_t *) &fpu_init_state[FXSAVE_FCW] = 0x37f;
+	*(uint32_t *) &fpu_init_state[FXSAVE_MXCSR] = 0x1f80;
+}
+
+/* Returns T's 16-byte aligned FXSAVE area. */
+static void *
+fpu_area (struct thread *t) {
+	return (void *) ROUND_UP ((uintptr_t) t->fpu_area, FPU_AREA_ALIGN);
+}
+
+/* Called on every context switch, with interrupts off.  Leaves
+   the FPU usable only if NEXT already owns its registers;
+   otherwise its first FPU instruction will fault into
+   device_not_available(). */
+void
+fpu_activate (struct thread *next) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (next == fpu_owner)
+		__asm __volatile ("clts");
+	else
+		lcr0 (rcr0 () | CR0_TS);
+}
+
+/* Drops the running thread's FPU state, on exit or exec.  A new
+   program starts from the initial FPU state on its first FPU
+   instruction. */
+void
+fpu_release (void) {
+	struct thread *curr = thread_current ();
+	enum intr_level old_level = intr_disable ();
+
+	if (fpu_owner == curr) {
+		fpu_owner = NULL;
+		lcr0 (rcr0 () | CR0_TS);
+	}
+	intr_set_level (old_level);
+
+	free (curr->fpu_area);
+	curr->fpu_area = NULL;
+}
+
+/* Gives the running thread, a child being forked from PARENT, an
+   initial FPU state with PARENT's x87 control word and MXCSR
+   control bits.  The SysV ABI treats those as callee-saved, so
+   they must survive the fork() call; the data registers need
+   not.  Returns false if out of memory. */
+bool
+fpu_fork (struct thread *parent) {
+	struct thread *curr = thread_current ();
+	uint8_t *area;
+	enum intr_level old_level;
+
+	/* PARENT never used the FPU, so its control words are the
+	   initial ones. */
+	if (parent->fpu_area == NULL)
+		return true;
+
+	curr->fpu_area = malloc (FPU_AREA_SIZE + FPU_AREA_ALIGN);
+	if (curr->fpu_area == NULL)
+		return false;
+	memcpy (fpu_area (curr), fpu_init_state, FPU_AREA_SIZE);
+
+	/* PARENT waits for us, so its state cannot change, but it may
+	   still be live in the FPU rather than in its save area. */
+	old_level = intr_disable ();
+	if (fpu_owner == parent) {
+		__asm __volatile ("clts");
+		__asm __volatile ("fxsave64 %0" : "=m" (*(uint8_t (*)[FPU_AREA_SIZE]) fpu_area (parent)));
+		lcr0 (rcr0 () | CR0_TS);
+	}
+	intr_set_level (old_level);
+
+	area = fpu_area (parent);
+	memcpy (fpu_area (curr) + FXSAVE_FCW, area + FXSAVE_FCW, sizeof (uint16_t));
+	*(uint32_t *) (fpu_area (curr) + FXSAVE_MXCSR) =
+		*(uint32_t *) (area + FXSAVE_MXCSR) & ~MXCSR_FLAGS;
+	return true;
 }
 
 /* Handler for an exception (probably) caused by a user process. */
@@ -106,6 +235,39 @@ kill (struct intr_frame *f) {
 	}
 }
 
+/* #NM handler.  The running thread executed an FPU or SSE
+   instruction while CR0.TS was set, i.e. while another thread's
+   state was in the FPU.  Saves that state, loads ours, and makes
+   us the owner.  On a thread's first FPU use, its save area is
+   allocated and filled with the initial state. */
+static void
+device_not_available (struct intr_frame *f) {
+	struct thread *curr = thread_current ();
+	enum intr_level old_level;
+
+	/* The kernel is built without FPU or SSE code. */
+	if (f->cs != SEL_UCSEG)
+		kill (f);
+
+	if (curr->fpu_area == NULL) {
+		curr->fpu_area = malloc (FPU_AREA_SIZE + FPU_AREA_ALIGN);
+		if (curr->fpu_area == NULL)
+			exit_handler (-1);
+		memcpy (fpu_area (curr), fpu_init_state, FPU_AREA_SIZE);
+	}
+
+	old_level = intr_disable ();
+	__asm __volatile ("clts");
+	if (fpu_owner != curr) {
+		if (fpu_owner != NULL)
+			__asm __volatile ("fxsave64 %0" : "=m" (*(uint8_t (*)[FPU_AREA_SIZE]) fpu_area (fpu_owner)));
+		__asm __volatile ("fxrstor64 %0" : : "m" (*(uint8_t (*)[FPU_AREA_SIZE]) fpu_area (curr)));
+		fpu_owner = curr;
+		fpu_switch_cnt++;
+	}
+	intr_set_level (old_level);
+}
+
 /* Page fault handler.  This is a skeleton that must be filled in
    to implement virtual memory.  Some solutions to project 2 may
    also require modifying this code.
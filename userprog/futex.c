@@ -0,0 +1,127 @@
+#include "userprog/futex.h"
+#include <debug.h>
+#include <hash.h>
+#include <stdint.h>
+#include "threads/interrupt.h"
+#include "threads/mmu.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* Fast user-space mutexes.
+
+   A futex is an int in user memory.  User code manipulates it
+   with atomic instructions and only calls into the kernel when
+   it has to sleep until the int changes, or to wake the threads
+   sleeping on it.  The kernel keeps no state for a futex apart
+   from its sleepers.
+
+   A futex is identified by the physical address behind its user
+   virtual address, so processes that map the same frame at
+   different addresses share it.  The waker must have the frame
+   mapped when it calls futex_wake(); sleepers whose frame was
+   evicted and read back elsewhere in between are not found.
+
+   Sleepers are kept in a fixed table of wait queues hashed on
+   that address, so wakeups go in priority order, FIFO among
+   equal priorities, like every other wait queue. */
+
+#define FUTEX_BUCKET_CNT 64     /* Number of hash buckets. */
+
+static struct wait_queue buckets[FUTEX_BUCKET_CNT];
+
+static uintptr_t futex_key (const int *uaddr);
+static struct wait_queue *futex_bucket (uintptr_t key);
+
+/* Initializes the futex table. */
+void
+futex_init (void) {
+	for (int i = 0; i < FUTEX_BUCKET_CNT; i++)
+		wait_queue_init (&buckets[i]);
+}
+
+/* If the int at user address UADDR still equals VAL, sleeps
+   until futex_wake() is called on it and returns true.
+   Otherwise returns false at once.  UADDR must be a valid,
+   aligned user address. */
+bool
+futex_wait (const int *uaddr, int val) {
+	struct thread *curr = thread_current ();
+	enum intr_level old_level;
+	uintptr_t key;
+
+	ASSERT (!intr_context ());
+
+	/* Comparing VAL and going to sleep must be atomic with
+	   respect to futex_wake(), so they happen with interrupts
+	   off, when UADDR cannot be evicted. */
+	old_level = intr_disable ();
+	key = futex_key (uaddr);
+	if (*(const int *) ptov (key) != val) {
+		intr_set_level (old_level);
+		return false;
+	}
+
+	curr->futex_key = key;
+	wait_queue_push (futex_bucket (key), curr);
+	thread_block ();
+	intr_set_level (old_level);
+	return true;
+}
+
+/* Wakes up to CNT threads sleeping on the int at user address
+   UADDR, highest priority first, and returns the number woken.
+   UADDR must be a valid, aligned user address. */
+int
+futex_wake (const int *uaddr, int cnt) {
+	struct wait_queue *wq;
+	struct rb_node *node, *next;
+	enum intr_level old_level;
+	uintptr_t key;
+	int woken = 0;
+
+	old_level = intr_disable ();
+	key = futex_key (uaddr);
+	wq = futex_bucket (key);
+	for (node = rb_first (&wq->threads); node != NULL && woken < cnt;
+			node = next) {
+		struct thread *t = rb_entry (node, struct thread, wait_node);
+
+		next = rb_next (node);
+		if (t->futex_key == key) {
+			wait_queue_remove (t);
+			thread_unblock (t);
+			woken++;
+		}
+	}
+	thread_try_preempt ();
+	intr_set_level (old_level);
+	return woken;
+}
+
+/* Returns the physical address behind user address UADDR.
+   Faults the page in first if needed, which may sleep, so on
+   return interrupts are off but may have been on for a while. */
+static uintptr_t
+futex_key (const int *uaddr) {
+	uint64_t *pml4 = thread_current ()->pml4;
+	void *kaddr;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while ((kaddr = pml4_get_page (pml4, uaddr)) == NULL) {
+		/* Touch the page with interrupts on, so that the page
+		   fault handler can bring it in. */
+		intr_enable ();
+		(void) *(volatile const int *) uaddr;
+		intr_disable ();
+	}
+	return vtop (kaddr);
+}
+
+/* Returns the wait queue that sleepers on physical address KEY
+   go in. */
+static struct wait_queue *
+futex_bucket (uintptr_t key) {
+	return &buckets[hash_bytes (&key, sizeof key) % FUTEX_BUCKET_CNT];
+}
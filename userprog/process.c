@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "userprog/exception.h"
 #include "userprog/gdt.h"
 #include "userprog/tss.h"
 #include "filesys/directory.h"
@@ -20,10 +21,11 @@
 #include "intrinsic.h"
 #include "devices/timer.h"
 #include "lib/string.h"
+#include "threads/slab.h"
+#include "userprog/syscall.h"
 #ifdef VM
 #include "vm/vm.h"
 #include "vm/uninit.h"
-#include "userprog/syscall.h"
 #endif
 
 static void process_cleanup (void);
@@ -160,6 +162,8 @@ __do_fork (void *aux) {
 
 	// process_activate으로 현재 프로세스의 pml4를 활성화하고, thread의 kernel stack을 설정
 	process_activate (current);
+	if (!fpu_fork (parent))
+		goto error;
 #ifdef VM
 	supplemental_page_table_init (&current->spt);
 	if (!supplemental_page_table_copy (&current->spt, &parent->spt))
@@ -184,7 +188,7 @@ __do_fork (void *aux) {
 			goto error;
 		}
 
-		struct fd_elem *child_fd_elem = malloc (sizeof (struct fd_elem));
+		struct fd_elem *child_fd_elem = kmem_cache_alloc (fd_elem_cache);
 		if (child_fd_elem == NULL) {
 			goto error;
 		}
@@ -307,7 +311,7 @@ process_exit (void) {
 	while (!list_empty(curr->fd_table)) {
 		fd_table_row = list_entry(list_pop_front(curr->fd_table), struct fd_elem, elem);
 		file_close(fd_table_row->file);
-		free(fd_table_row);
+		kmem_cache_free (fd_elem_cache, fd_table_row);
 	}
 
 	// Free the file descriptor table
@@ -375,6 +379,9 @@ process_cleanup (void) {
 	}
 	// 향후의 사용/재거를 위해 exec_file은 NULL로 초기화
 	curr->exec_file = NULL;
+
+	// FPU 상태도 버린다. 새 프로그램은 초기 FPU 상태에서 시작.
+	fpu_release ();
 }
 
 /* Sets up the CPU for running user code in the nest thread.
@@ -386,6 +393,9 @@ process_activate (struct thread *next) {
 
 	/* Set thread's kernel stack for use in processing interrupts. */
 	tss_update (next);
+
+	/* Trap the first FPU use unless NEXT's state is still loaded. */
+	fpu_activate (next);
 }
 
 struct thread *
@@ -420,9 +430,9 @@ get_child_process (tid_t child_tid) {
 #define PT_PHDR    6            /* Program header table. */
 #define PT_STACK   0x6474e551   /* Stack segment. */
 
-#define PF_X 1          /* Executable. */
-#define PF_W 2          /* Writable. */
-#define PF_R 4          /* Readable. */
+#define ELF_PF_X 1      /* Executable. */
+#define ELF_PF_W 2      /* Writable. */
+#define ELF_PF_R 4      /* Readable. */
 
 /* Executable header.  See [ELF1] 1-4 to 1-8.
  * This appears at the very beginning of an ELF binary. */
@@ -554,7 +564,7 @@ load (const char *file_name, struct intr_frame *if_) {
 				goto done;
 			case PT_LOAD:
 				if (validate_segment (&phdr, file)) {
-					bool writable = (phdr.p_flags & PF_W) != 0;
+					bool writable = (phdr.p_flags & ELF_PF_W) != 0;
 					uint64_t file_page = phdr.p_offset & ~PGMASK;
 					uint64_t mem_page = phdr.p_vaddr & ~PGMASK;
 					uint64_t page_offset = phdr.p_vaddr & PGMASK;
@@ -604,6 +614,13 @@ load (const char *file_name, struct intr_frame *if_) {
 	// Word-align the stack pointer, 스택 포인터를 8의 배수로 정렬
 	// e.g. 0x4747ffe8	word-align	0	uint8_t[]
 	if_->rsp = (void *) ((uintptr_t) if_->rsp & ~0xf);
+
+	// _start에 진입할 때 ABI대로 (rsp + 8)이 16의 배수가 되도록 padding.
+	// SSE 명령어(movaps 등)는 16-byte 정렬된 stack을 요구한다.
+	if ((argc + 1) % 2 == 1) {
+		if_->rsp -= sizeof (void *);
+		*(uintptr_t *) if_->rsp = 0;
+	}
 	
 	// Push the address of each string plus a null pointer sentinel, on the stack, in right-to-left order. These are the elements of argv.
 	// The null pointer sentinel ensures that argv[argc] is a null pointer, as required by the C standard. The order ensures that argv[0] is at the lowest virtual address. Word-aligned accesses are faster than unaligned accesses, so for best performance round the stack pointer down to a multiple of 8 before the first push.
@@ -837,7 +854,7 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
 
 		/* TODO: Set up aux to pass information to the lazy_load_segment. */
 		// aux에 file, ofs, read_bytes, zero_bytes, writable 정보를 담아서 lazy_load_segment 함수에 전달
-		struct lazy_load_info *info = malloc(sizeof(struct lazy_load_info));
+		struct lazy_load_info *info = kmem_cache_alloc (lazy_load_info_cache);
 		info->file = file;
 		info->ofs = ofs;
 		info->read_bytes = page_read_bytes;
@@ -15,6 +15,9 @@
 #include "userprog/process.h"
 #include "lib/user/syscall.h"
 #include "threads/palloc.h"
+#include "userprog/futex.h"
+#include "devices/timer.h"
+#include "threads/slab.h"
 
 void syscall_entry (void);
 void syscall_handler (struct intr_frame *);
@@ -32,6 +35,12 @@ static int write_handler (int fd, const void *buffer, unsigned size);
 static void seek_handler (int fd, unsigned position);
 static unsigned tell_handler (int fd);
 static void close_handler (int fd);
+static bool sched_deadline_handler (int runtime, int deadline, int period);
+static bool cpu_max_handler (int quota, int period);
+static int64_t cpu_throttled_handler (void);
+static void sched_stats_handler (struct sched_stats *stats);
+static int futex_handler (int *uaddr, int op, int val);
+static int64_t clock_ns_handler (void);
 
 #ifdef VM
 static void *mmap_handler (void *addr, size_t length, int writable, int fd, off_t offset);
@@ -45,6 +54,7 @@ static void validate_address_range (const void *addr, unsigned size, bool is_rea
 static void validate_string_range (const char *addr);
 
 struct lock syscall_lock;
+struct kmem_cache *fd_elem_cache;
 // struct lock file_lock;
 
 /* System call.
@@ -75,6 +85,13 @@ syscall_init (void) {
 	next_fd = 2; // 0 is STDIN_FILENO, 1 is STDOUT_FILENO
 	lock_init(&file_lock);
 	lock_init(&syscall_lock);
+	// file system을 쓰는 process들이 file_lock에 몰리므로 waiter에게 바로 넘겨준다.
+	lock_set_handoff(&file_lock, true);
+	futex_init ();
+
+	fd_elem_cache = kmem_cache_create ("fd_elem", sizeof (struct fd_elem), NULL);
+	if (fd_elem_cache == NULL)
+		PANIC ("syscall_init: cannot create fd_elem cache");
 }
 
 /* The main system call interface */
@@ -145,6 +162,24 @@ syscall_handler (struct intr_frame *f UNUSED) {
 			munmap_handler ((void *) f->R.rdi);
 			break;
 #endif
+		case SYS_SCHED_DEADLINE:		/* Join or leave the deadline class. */
+			f->R.rax = sched_deadline_handler (f->R.rdi, f->R.rsi, f->R.rdx);
+			break;
+		case SYS_CPU_MAX:				/* Limit the CPU time of a process tree. */
+			f->R.rax = cpu_max_handler (f->R.rdi, f->R.rsi);
+			break;
+		case SYS_CPU_THROTTLED:			/* Report ticks spent throttled. */
+			f->R.rax = cpu_throttled_handler ();
+			break;
+		case SYS_SCHED_STATS:			/* Report scheduling statistics. */
+			sched_stats_handler ((struct sched_stats *) f->R.rdi);
+			break;
+		case SYS_FUTEX:					/* Wait on or wake a shared int. */
+			f->R.rax = futex_handler ((int *) f->R.rdi, f->R.rsi, f->R.rdx);
+			break;
+		case SYS_CLOCK_NS:				/* Read the monotonic clock. */
+			f->R.rax = clock_ns_handler ();
+			break;
 		default:
 			exit_handler (-1);
 			break;
@@ -517,6 +552,75 @@ munmap_handler (void *addr) {
 }
 #endif
 
+/**
+ * Puts the calling thread in the deadline (EDF) scheduling class with a budget of runtime ticks every period ticks, to be consumed within deadline ticks of each period's start. A runtime of 0 returns the thread to the priority scheduler. Returns false if the parameters are invalid or the reservation fails admission control.
+ */
+bool
+sched_deadline_handler (int runtime, int deadline, int period) {
+	return thread_set_deadline (runtime, deadline, period);
+}
+
+/**
+ * Limits the calling process, and every process it creates afterwards, to quota ticks of CPU time per period ticks in total. Once the quota is used up they are not scheduled again until the next period. A limit that is already set can only be tightened, and a quota of -1 only has an effect before one is. Returns false if the arguments are invalid or would loosen the limit.
+ */
+bool
+cpu_max_handler (int quota, int period) {
+	return thread_set_cpu_max (quota, period);
+}
+
+/**
+ * Returns the number of ticks the calling process's group has spent throttled by its CPU limit.
+ */
+int64_t
+cpu_throttled_handler (void) {
+	return thread_get_cpu_throttled ();
+}
+
+/**
+ * Fills in stats with the calling thread's scheduling statistics: the time it has spent ready but waiting for the CPU, how often it was woken, how often it gave up the CPU by blocking or was preempted, and the timer ticks it spent in user and kernel mode.
+ */
+void
+sched_stats_handler (struct sched_stats *stats) {
+	struct sched_stats copy;
+
+	/* STATS may straddle a page boundary, and only the page of
+	   its first byte is checked for the whole range. */
+	validate_address_range (stats, sizeof *stats, true);
+	validate_address_range ((uint8_t *) stats + sizeof *stats - 1, 1, true);
+
+	/* Writing to user memory can fault, so not with interrupts
+	   off. */
+	thread_get_sched_stats (&copy);
+	*stats = copy;
+}
+
+/**
+ * With op FUTEX_WAIT, sleeps until another process calls FUTEX_WAKE on the int at uaddr, provided it still equals val, and returns 0; returns -1 at once if it does not. With op FUTEX_WAKE, wakes up to val processes sleeping on uaddr and returns how many it woke. The int is identified by the physical memory behind uaddr. Returns -1 if uaddr is not aligned or op is invalid.
+ */
+int
+futex_handler (int *uaddr, int op, int val) {
+	validate_address_range (uaddr, sizeof *uaddr, false);
+	if ((uintptr_t) uaddr % sizeof *uaddr != 0)
+		return -1;
+
+	switch (op) {
+		case FUTEX_WAIT:
+			return futex_wait (uaddr, val) ? 0 : -1;
+		case FUTEX_WAKE:
+			return val > 0 ? futex_wake (uaddr, val) : 0;
+		default:
+			return -1;
+	}
+}
+
+/**
+ * Returns the number of nanoseconds since the OS booted. The clock never goes backward, and has the resolution of the TSC once the kernel has calibrated it.
+ */
+int64_t
+clock_ns_handler (void) {
+	return timer_ns ();
+}
+
 
 /**
  * Returns the file associated with the file descriptor fd from the file descriptor table of the current thread.
@@ -540,7 +644,7 @@ add_file_to_fd_table (struct file *file) {
 	struct thread *curr_thread = thread_current ();
 	struct list *fdt = curr_thread->fd_table;
 
-	struct fd_elem *fd_elem = malloc (sizeof (struct fd_elem));
+	struct fd_elem *fd_elem = kmem_cache_alloc (fd_elem_cache);
 	if (fd_elem == NULL) {
 		return -1;
 	}
@@ -570,7 +674,7 @@ remove_file_from_fd_table (int fd) {
 			file_close (fd_elem->file);
 			lock_release (&file_lock);
 
-			free (fd_elem);
+			kmem_cache_free (fd_elem_cache, fd_elem);
 			return true;
 		}
 	}
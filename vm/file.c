@@ -6,6 +6,7 @@
 #include "lib/string.h"
 #include "userprog/process.h"
 #include "vm/uninit.h"
+#include "threads/slab.h"
 
 static bool file_backed_swap_in (struct page *page, void *kva);
 static bool file_backed_swap_out (struct page *page);
@@ -129,7 +130,7 @@ do_mmap (void *addr, size_t length, int writable,
 		size_t page_read_bytes = read_byte < PGSIZE ? read_byte : PGSIZE;
 		size_t page_zero_bytes = PGSIZE - page_read_bytes; // 0 if not fragmented, page is fragmented in case of the last page
 
-		struct lazy_load_info *info = (struct lazy_load_info *) malloc (sizeof(struct lazy_load_info));
+		struct lazy_load_info *info = kmem_cache_alloc (lazy_load_info_cache);
 		info->file = open_file;
 		info->ofs = offset;
 		info->read_bytes = page_read_bytes;
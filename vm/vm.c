@@ -8,10 +8,17 @@
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
 #include "threads/mmu.h"
+#include "threads/slab.h"
 
 struct list frame_table;
 struct lock frame_table_lock;
 
+/* Object caches for the structures allocated on every fault and
+   every lazily loaded page. */
+static struct kmem_cache *vm_page_cache;
+static struct kmem_cache *vm_frame_cache;
+struct kmem_cache *lazy_load_info_cache;
+
 /* Initializes the virtual memory subsystem by invoking each subsystem's
  * intialize codes. */
 void
@@ -27,6 +34,14 @@ vm_init (void) {
 
 	list_init(&frame_table);
 	lock_init(&frame_table_lock);
+
+	vm_page_cache = kmem_cache_create ("page", sizeof (struct page), NULL);
+	vm_frame_cache = kmem_cache_create ("frame", sizeof (struct frame), NULL);
+	lazy_load_info_cache = kmem_cache_create ("lazy_load_info",
+			sizeof (struct lazy_load_info), NULL);
+	if (vm_page_cache == NULL || vm_frame_cache == NULL
+			|| lazy_load_info_cache == NULL)
+		PANIC ("vm_init: cannot create object caches");
 }
 
 /* Get the type of the page. This function is useful if you want to know the
@@ -67,7 +82,7 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable, v
 		
 		// create the page
 		// struct page *page = palloc_get_page (0);
-		struct page *page = malloc(sizeof(struct page)); // palloc 대신 malloc을 써야 하는 이유는 palloc_get_page는 고정된 사이즈의 메모리만 할당해주기 때문에 page fault가 발생할 수 있음
+		struct page *page = kmem_cache_alloc (vm_page_cache);
 		if(page==NULL){
 			// page에 메모리 할당 못해줄 경우, 바로 false return
 			return false;
@@ -204,7 +219,7 @@ vm_get_frame (void) {
 		return victim_frame;
 	}
 
-	struct frame *frame = (struct frame *) malloc (sizeof (struct frame));
+	struct frame *frame = kmem_cache_alloc (vm_frame_cache);
 
 	frame->kva = kva;
 	frame->page = NULL;
@@ -291,7 +306,7 @@ vm_try_handle_fault (struct intr_frame *f , void *addr ,
 void
 vm_dealloc_page (struct page *page) {
 	destroy (page);
-	free (page);
+	kmem_cache_free (vm_page_cache, page);
 }
 
 /* Claim the page that allocate on VA. */